@@ -0,0 +1,127 @@
+#include "uvent/Uvent.h"
+#include "uredis/RedisClusterClient.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace usub::uvent;
+using namespace usub::uredis;
+
+// Usage: uredis_bench_cluster_batch [host] [port] [keys]
+// Reads `keys` keys with one GET per key through command() and with group_by_node() plus one
+// pipelined MGET-per-slot write per node through execute_on_node().
+
+namespace
+{
+    std::string g_host = "127.0.0.1";
+    std::uint16_t g_port = 7000;
+    std::size_t g_key_count = 10000;
+    constexpr int rounds = 5;
+
+    double us_per_key(std::chrono::steady_clock::time_point start, std::size_t keys)
+    {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(us) / (static_cast<double>(keys) * rounds);
+    }
+
+    task::Awaitable<bool> naive(RedisClusterClient& cluster, const std::vector<std::string_view>& keys)
+    {
+        for (auto k : keys)
+        {
+            auto r = co_await cluster.command("GET", k);
+            if (!r)
+            {
+                std::printf("GET failed: %s\n", r.error().message.c_str());
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    task::Awaitable<bool> batched(RedisClusterClient& cluster, const std::vector<std::string_view>& keys)
+    {
+        auto groups = co_await cluster.group_by_node(keys);
+        if (!groups)
+        {
+            std::printf("group_by_node failed: %s\n", groups.error().message.c_str());
+            co_return false;
+        }
+
+        for (auto& g : *groups)
+        {
+            std::vector<std::vector<std::string_view>> args;
+            args.reserve(g.slots.size());
+            for (auto& sg : g.slots)
+            {
+                auto& a = args.emplace_back();
+                a.reserve(sg.indices.size());
+                for (auto i : sg.indices) a.push_back(keys[i]);
+            }
+
+            std::vector<RedisCommandView> cmds;
+            cmds.reserve(args.size());
+            for (auto& a : args) cmds.push_back(RedisCommandView{"MGET", a});
+
+            auto r = co_await cluster.execute_on_node(g.node, cmds);
+            if (!r)
+            {
+                std::printf("execute_on_node failed: %s\n", r.error().message.c_str());
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    task::Awaitable<void> run()
+    {
+        RedisClusterConfig cfg;
+        cfg.seeds.push_back(RedisClusterNode{g_host, g_port});
+        RedisClusterClient cluster{cfg};
+
+        auto c = co_await cluster.connect();
+        if (!c)
+        {
+            std::printf("connect failed: %s\n", c.error().message.c_str());
+            std::exit(1);
+        }
+
+        std::vector<std::string> owned;
+        owned.reserve(g_key_count);
+        for (std::size_t i = 0; i < g_key_count; ++i)
+            owned.push_back("bench:batch:" + std::to_string(i));
+        std::vector<std::string_view> keys(owned.begin(), owned.end());
+
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            if (!co_await naive(cluster, keys)) std::exit(1);
+        const double t_naive = us_per_key(start, keys.size());
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            if (!co_await batched(cluster, keys)) std::exit(1);
+        const double t_batched = us_per_key(start, keys.size());
+
+        const auto groups = RedisClusterClient::group_by_slot(keys);
+
+        std::printf("%-12s %8s %14s %14s\n", "keys", "slots", "per-key GET", "slot batches");
+        std::printf("%-12zu %8zu %11.3f us %11.3f us\n", keys.size(), groups.size(), t_naive, t_batched);
+        std::exit(0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1) g_host = argv[1];
+    if (argc > 2) g_port = static_cast<std::uint16_t>(std::atoi(argv[2]));
+    if (argc > 3) g_key_count = static_cast<std::size_t>(std::atoll(argv[3]));
+
+    usub::Uvent uvent(1);
+    system::co_spawn(run());
+    uvent.run();
+    return 0;
+}
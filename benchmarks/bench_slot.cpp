@@ -0,0 +1,130 @@
+#include "uredis/RedisSlot.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace usub::uredis;
+
+namespace
+{
+    std::uint16_t slot_bitwise(std::string_view key)
+    {
+        auto l = key.find('{');
+        if (l != std::string_view::npos)
+        {
+            auto r = key.find('}', l + 1);
+            if (r != std::string_view::npos && r != l + 1)
+                key = key.substr(l + 1, r - l - 1);
+        }
+
+        std::uint16_t crc = 0;
+        for (unsigned char b : key)
+        {
+            crc ^= static_cast<std::uint16_t>(b) << 8;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (crc & 0x8000)
+                    crc = static_cast<std::uint16_t>((crc << 1) ^ 0x1021);
+                else
+                    crc = static_cast<std::uint16_t>(crc << 1);
+            }
+        }
+        return static_cast<std::uint16_t>(crc % 16384);
+    }
+
+    std::vector<std::string> make_keys(std::size_t count, std::size_t min_len, std::size_t max_len, bool tagged)
+    {
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<std::size_t> len_dist(min_len, max_len);
+        std::uniform_int_distribution<int> ch_dist('a', 'z');
+
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::string k(len_dist(rng), 'x');
+            for (auto& c : k) c = static_cast<char>(ch_dist(rng));
+            if (tagged && k.size() > 8)
+            {
+                k[2] = '{';
+                k[7] = '}';
+            }
+            keys.push_back(std::move(k));
+        }
+        return keys;
+    }
+
+    template <typename F>
+    double ns_per_key(const std::vector<std::string_view>& keys, int rounds, F&& f)
+    {
+        std::uint64_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            sink += f(keys);
+        const auto end = std::chrono::steady_clock::now();
+
+        if (sink == 0xdeadbeef) std::puts("");
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        return static_cast<double>(ns) / (static_cast<double>(keys.size()) * rounds);
+    }
+}
+
+int main()
+{
+    struct Dist
+    {
+        const char* name;
+        std::size_t min_len;
+        std::size_t max_len;
+        bool tagged;
+    };
+
+    const Dist dists[] = {
+        {"short 4..16", 4, 16, false},
+        {"medium 16..48", 16, 48, false},
+        {"long 64..256", 64, 256, false},
+        {"tagged 16..64", 16, 64, true},
+    };
+
+    constexpr std::size_t key_count = 50000;
+    constexpr int rounds = 20;
+
+    std::printf("%-16s %12s %12s %12s\n", "keys", "bitwise", "slot_of", "slots_of");
+
+    for (const auto& d : dists)
+    {
+        auto owned = make_keys(key_count, d.min_len, d.max_len, d.tagged);
+        std::vector<std::string_view> keys(owned.begin(), owned.end());
+        std::vector<std::uint16_t> out(keys.size());
+
+        const double t_bitwise = ns_per_key(keys, rounds, [](const auto& ks)
+        {
+            std::uint64_t s = 0;
+            for (auto k : ks) s += slot_bitwise(k);
+            return s;
+        });
+
+        const double t_single = ns_per_key(keys, rounds, [](const auto& ks)
+        {
+            std::uint64_t s = 0;
+            for (auto k : ks) s += slot_of(k);
+            return s;
+        });
+
+        const double t_batch = ns_per_key(keys, rounds, [&out](const auto& ks)
+        {
+            slots_of(ks, out);
+            return static_cast<std::uint64_t>(out.back());
+        });
+
+        std::printf("%-16s %9.2f ns %9.2f ns %9.2f ns\n", d.name, t_bitwise, t_single, t_batch);
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "uvent/Uvent.h"
+#include "uredis/RedisClient.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace usub::uvent;
+using namespace usub::uredis;
+
+// Usage: uredis_bench_unix_socket [unix_path] [host] [port] [requests]
+// Round-trip latency of PING and of a 64-byte GET, one request at a time, over loopback TCP and
+// over the Unix socket of the same server (redis.conf: `unixsocket /tmp/redis.sock`).
+
+namespace
+{
+    std::string g_unix_path = "/tmp/redis.sock";
+    std::string g_host = "127.0.0.1";
+    std::uint16_t g_port = 6379;
+    std::size_t g_requests = 100000;
+
+    struct Latency
+    {
+        double mean_us{0};
+        double p50_us{0};
+        double p99_us{0};
+    };
+
+    Latency summarize(std::vector<double>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+        return Latency{
+            sum / static_cast<double>(samples.size()),
+            samples[samples.size() / 2],
+            samples[samples.size() * 99 / 100],
+        };
+    }
+
+    task::Awaitable<bool> measure(RedisClient& client, std::string_view cmd, std::string_view arg, Latency& out)
+    {
+        std::vector<double> samples;
+        samples.reserve(g_requests);
+
+        for (std::size_t i = 0; i < g_requests; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            auto r = arg.empty() ? co_await client.command(cmd) : co_await client.command(cmd, arg);
+            const auto end = std::chrono::steady_clock::now();
+            if (!r)
+            {
+                std::printf("%.*s failed: %s\n", static_cast<int>(cmd.size()), cmd.data(), r.error().message.c_str());
+                co_return false;
+            }
+            samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+
+        out = summarize(samples);
+        co_return true;
+    }
+
+    task::Awaitable<bool> run_one(const char* name, RedisConfig cfg)
+    {
+        RedisClient client{cfg};
+        auto c = co_await client.connect();
+        if (!c)
+        {
+            std::printf("%s: connect failed: %s\n", name, c.error().message.c_str());
+            co_return false;
+        }
+
+        auto s = co_await client.set("bench:uds", std::string(64, 'x'));
+        if (!s)
+        {
+            std::printf("%s: SET failed: %s\n", name, s.error().message.c_str());
+            co_return false;
+        }
+
+        Latency ping, get;
+        if (!co_await measure(client, "PING", {}, ping)) co_return false;
+        if (!co_await measure(client, "GET", "bench:uds", get)) co_return false;
+
+        std::printf("%-6s %-5s %9.2f us %9.2f us %9.2f us\n", name, "PING", ping.mean_us, ping.p50_us, ping.p99_us);
+        std::printf("%-6s %-5s %9.2f us %9.2f us %9.2f us\n", name, "GET", get.mean_us, get.p50_us, get.p99_us);
+        co_return true;
+    }
+
+    task::Awaitable<void> run()
+    {
+        RedisConfig tcp;
+        tcp.host = g_host;
+        tcp.port = g_port;
+
+        RedisConfig uds = tcp;
+        uds.unix_path = g_unix_path;
+
+        std::printf("%-6s %-5s %12s %12s %12s\n", "via", "cmd", "mean", "p50", "p99");
+        if (!co_await run_one("tcp", tcp)) std::exit(1);
+        if (!co_await run_one("unix", uds)) std::exit(1);
+        std::exit(0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1) g_unix_path = argv[1];
+    if (argc > 2) g_host = argv[2];
+    if (argc > 3) g_port = static_cast<std::uint16_t>(std::atoi(argv[3]));
+    if (argc > 4) g_requests = std::max<std::size_t>(1, static_cast<std::size_t>(std::atoll(argv[4])));
+
+    usub::Uvent uvent(1);
+    system::co_spawn(run());
+    uvent.run();
+    return 0;
+}
@@ -0,0 +1,136 @@
+#ifndef UREDIS_REDISBLOCKINGPOOL_H
+#define UREDIS_REDISBLOCKINGPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncMutex.h"
+#include "uvent/sync/AsyncSemaphore.h"
+
+#include "uredis/RedisClient.h"
+#include "uredis/RedisMultiplexedConnection.h"
+
+namespace usub::uredis
+{
+    namespace task = usub::uvent::task;
+    namespace sync = usub::uvent::sync;
+
+    struct RedisBlockingPoolConfig
+    {
+        RedisConfig redis;
+
+        std::size_t max_connections{64}; // callers beyond this wait for a free connection
+        std::size_t max_idle{8};         // connections kept open for reuse
+
+        // client-side timeout = server block time + margin
+        int timeout_margin_ms{1000};
+    };
+
+    // Blocking commands (BLPOP, BRPOP, BLMOVE, XREAD BLOCK, ...) on their own connections,
+    // opened on demand and reused while idle, so a long block never holds a RedisClient or pool
+    // connection of the request path. A call can be cancelled from another coroutine through a
+    // CancelToken: the pool sends CLIENT UNBLOCK for the connection the call is blocked on.
+    class RedisBlockingPool
+    {
+    public:
+        struct CancelToken
+        {
+            std::atomic<bool> cancelled{false};
+            std::atomic<std::int64_t> client_id{-1}; // connection blocked on behalf of the token
+        };
+
+        explicit RedisBlockingPool(RedisBlockingPoolConfig cfg);
+
+        // `args` must carry the server-side timeout; `block` is the same time and sets the
+        // client timeout. The command is sent once: no retry on I/O errors.
+        task::Awaitable<RedisResult<RedisValue>> command(
+            std::string_view cmd,
+            std::span<const std::string_view> args,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel = {});
+
+        // nullopt: timed out (or cancelled with nothing popped)
+        task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> blpop(
+            std::span<const std::string_view> keys,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel = {});
+
+        task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> brpop(
+            std::span<const std::string_view> keys,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel = {});
+
+        // where_from / where_to: "LEFT" or "RIGHT"
+        task::Awaitable<RedisResult<std::optional<std::string>>> blmove(
+            std::string_view source,
+            std::string_view destination,
+            std::string_view where_from,
+            std::string_view where_to,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel = {});
+
+        // XREAD COUNT count BLOCK block STREAMS keys... ids...; null reply on timeout
+        task::Awaitable<RedisResult<RedisValue>> xread(
+            std::span<const std::string_view> keys,
+            std::span<const std::string_view> ids,
+            std::size_t count,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel = {});
+
+        // WAIT only counts the writes of its own connection, so it runs on the caller's client,
+        // with that client's timeout raised to block plus the margin for the call. Returns the
+        // number of replicas that acknowledged; not cancellable.
+        task::Awaitable<RedisResult<int64_t>> wait(
+            RedisClient& client,
+            int64_t num_replicas,
+            std::chrono::milliseconds block);
+
+        // Marks the token cancelled and unblocks the call waiting on it, if any. A call that
+        // already got a value still returns it.
+        task::Awaitable<void> cancel(std::shared_ptr<CancelToken> token);
+
+        [[nodiscard]] std::size_t open_connections() const noexcept
+        {
+            return this->open_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Conn
+        {
+            std::shared_ptr<RedisClient> client;
+            std::int64_t id{-1};
+        };
+
+        RedisBlockingPoolConfig cfg_;
+
+        sync::AsyncSemaphore slots_;
+        sync::AsyncMutex idle_mutex_;
+        std::vector<Conn> idle_;
+        std::atomic<std::size_t> open_{0};
+
+        // CLIENT UNBLOCK goes here, never over a blocking connection
+        RedisMultiplexedConnection control_;
+
+        task::Awaitable<RedisResult<Conn>> acquire();
+        task::Awaitable<void> release(Conn conn, bool reusable);
+
+        task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> pop(
+            std::string_view cmd,
+            std::span<const std::string_view> keys,
+            std::chrono::milliseconds block,
+            std::shared_ptr<CancelToken> cancel);
+
+        static std::string seconds(std::chrono::milliseconds block);
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISBLOCKINGPOOL_H
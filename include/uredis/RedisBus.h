@@ -1,8 +1,10 @@
 #ifndef UREDIS_REDISBUS_H
 #define UREDIS_REDISBUS_H
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -11,6 +13,8 @@
 #include "uvent/Uvent.h"
 #include "uvent/sync/AsyncMutex.h"
 #include "uredis/RedisClient.h"
+#include "uredis/RedisGlob.h"
+#include "uredis/RedisMultiplexedConnection.h"
 #include "uredis/RedisSubscriber.h"
 #include "uredis/RedisTypes.h"
 
@@ -25,6 +29,9 @@ namespace usub::uredis
     public:
         using Callback = std::function<void(const std::string& channel,
                                             const std::string& payload)>;
+        // Zero-copy handler: the views point into the read buffer (or, for a loopback delivery,
+        // at the arguments of publish) and are only valid during the call.
+        using ViewCallback = RedisSubscriber::MessageViewCallback;
 
         struct Config
         {
@@ -32,6 +39,19 @@ namespace usub::uredis
             int ping_interval_ms{5000};
             int reconnect_delay_ms{2000};
 
+            // PUBLISH goes over this many multiplexed connections (least loaded first); concurrent
+            // publishers are pipelined instead of waiting for each other.
+            std::size_t publish_connections{2};
+            std::size_t max_inflight_per_publisher{1024};
+
+            // handler offload for the subscribe connection, see RedisSubscriber::DispatchOptions
+            RedisSubscriber::DispatchOptions dispatch;
+
+            // Loopback: publish() delivers to this bus's own handlers in process right away, and
+            // the copy echoed back by Redis is dropped. Payloads on the wire carry an origin tag,
+            // so every party on such channels must be a RedisBus with loopback enabled.
+            bool loopback{false};
+
             std::function<void(const RedisError&)> on_error;
             std::function<void()> on_reconnect;
         };
@@ -40,10 +60,14 @@ namespace usub::uredis
 
         task::Awaitable<void> run();
 
+        // Takes no bus lock; channel and payload are encoded straight from the views.
         task::Awaitable<RedisResult<void>> publish(
             std::string_view channel,
             std::string_view payload);
 
+        // Fire-and-forget: returns immediately, failures are reported through on_error.
+        void publish_detached(std::string channel, std::string payload);
+
         task::Awaitable<RedisResult<void>> subscribe(
             std::string channel,
             Callback cb);
@@ -52,22 +76,78 @@ namespace usub::uredis
             std::string pattern,
             Callback cb);
 
+        task::Awaitable<RedisResult<void>> subscribe_view(
+            std::string channel,
+            ViewCallback cb);
+
+        task::Awaitable<RedisResult<void>> psubscribe_view(
+            std::string pattern,
+            ViewCallback cb);
+
+        // Bulk variants, sent as multi-argument frames in one write.
+        task::Awaitable<RedisResult<void>> subscribe(
+            std::span<const std::string> channels,
+            Callback cb);
+
+        task::Awaitable<RedisResult<void>> psubscribe(
+            std::span<const std::string> patterns,
+            Callback cb);
+
         task::Awaitable<RedisResult<void>> unsubscribe(std::string channel);
         task::Awaitable<RedisResult<void>> punsubscribe(std::string pattern);
 
         task::Awaitable<void> close();
 
     private:
+        struct Handler
+        {
+            Callback owned{};
+            ViewCallback view{};
+
+            void operator()(std::string_view channel, std::string_view payload) const
+            {
+                if (this->view)
+                    this->view(channel, payload);
+                else if (this->owned)
+                    this->owned(std::string(channel), std::string(payload));
+            }
+        };
+
+        // transparent hash: loopback looks channels up by the publisher's view
+        struct NameHash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view s) const noexcept
+            {
+                return std::hash<std::string_view>{}(s);
+            }
+        };
+
+        // Loopback snapshot, rebuilt on (un)subscribe; patterns are compiled once here.
+        struct LocalHandlers
+        {
+            std::unordered_map<std::string, Handler, NameHash, std::equal_to<>> channels;
+            GlobTrie patterns;
+            std::vector<Handler> pattern_handlers; // indexed by the trie values
+        };
+
+        // "\x1eUB" + 16 hex digits of the origin id + "\x1e"
+        static constexpr std::size_t origin_tag_size = 20;
+
         Config cfg_;
+        std::string origin_;
+        std::atomic<std::shared_ptr<const LocalHandlers>> local_;
 
-        std::shared_ptr<RedisClient> pub_client_;
         std::shared_ptr<RedisSubscriber> sub_client_;
 
+        std::vector<std::shared_ptr<RedisMultiplexedConnection>> publishers_;
+
         bool connected_{false};
-        bool stopping_{false};
+        std::atomic<bool> stopping_{false};
 
-        std::unordered_map<std::string, Callback> desired_channels_;
-        std::unordered_map<std::string, Callback> desired_patterns_;
+        std::unordered_map<std::string, Handler> desired_channels_;
+        std::unordered_map<std::string, Handler> desired_patterns_;
 
         sync::AsyncMutex mutex_;
 
@@ -75,13 +155,29 @@ namespace usub::uredis
         task::Awaitable<RedisResult<void>> resubscribe_all_locked();
         task::Awaitable<void> run_loop();
 
+        std::shared_ptr<RedisMultiplexedConnection> pick_publisher() const;
+
+        void refresh_local_locked();
+        void deliver_local(std::string_view channel, std::string_view payload) const;
+        std::string tag_payload(std::string_view payload) const;
+        ViewCallback wrap(Handler h) const;
+
+        task::Awaitable<RedisResult<void>> subscribe_handler(std::string channel, Handler h);
+        task::Awaitable<RedisResult<void>> psubscribe_handler(std::string pattern, Handler h);
+
+        static task::Awaitable<void> publish_task(
+            std::shared_ptr<RedisMultiplexedConnection> pub,
+            std::string channel,
+            std::string payload,
+            std::function<void(const RedisError&)> on_error);
+
         RedisResult<void> apply_subscribe_locked(
             const std::string& channel,
-            const Callback& cb);
+            const Handler& h);
 
         RedisResult<void> apply_psubscribe_locked(
             const std::string& pattern,
-            const Callback& cb);
+            const Handler& h);
 
         RedisResult<void> apply_unsubscribe_locked(const std::string& channel);
         RedisResult<void> apply_punsubscribe_locked(const std::string& pattern);
@@ -33,6 +33,16 @@ namespace usub::uredis {
 
         int connect_timeout_ms{5000};
         int io_timeout_ms{5000};
+
+        bool readonly{false};
+
+        // non-empty: connect to this Unix domain socket instead of host:port
+        std::string unix_path;
+    };
+
+    struct RedisCommandView {
+        std::string_view cmd;
+        std::span<const std::string_view> args;
     };
 
     class RedisClient {
@@ -57,6 +67,17 @@ namespace usub::uredis {
             co_return co_await this->command(cmd, std::span<const std::string_view>(arr.data(), arr.size()));
         }
 
+        // Writes all commands in one frame and reads their replies in order. Server errors are
+        // reported per command; an I/O error fails the whole pipeline (no automatic retry).
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > > pipeline(
+            std::span<const RedisCommandView> cmds);
+
+        // Same, with the socket timeout set to timeout_ms for this call only (e.g. block time plus a
+        // margin); io_timeout_ms is left untouched for other calls.
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > > pipeline(
+            std::span<const RedisCommandView> cmds,
+            int timeout_ms);
+
         task::Awaitable<RedisResult<std::optional<std::string> > > get(std::string_view key);
 
         task::Awaitable<RedisResult<void> > set(std::string_view key, std::string_view value);
@@ -96,6 +117,13 @@ namespace usub::uredis {
 
         const RedisConfig &config() const { return config_; }
 
+        // Connected socket for cfg: the Unix socket at cfg.unix_path if set, TCP to host:port otherwise.
+        static task::Awaitable<RedisResult<std::shared_ptr<net::TCPClientSocket> > > open_socket(
+            const RedisConfig &cfg);
+
+        // "unix:<path>" or "host:port", for logs and error messages.
+        static std::string endpoint(const RedisConfig &cfg);
+
     private:
         RedisConfig config_{};
         std::shared_ptr<net::TCPClientSocket> socket_{};
@@ -117,7 +145,12 @@ namespace usub::uredis {
             std::string_view cmd,
             std::span<const std::string_view> args);
 
-        task::Awaitable<RedisResult<RedisValue> > read_one_reply_unlocked();
+        task::Awaitable<RedisResult<RedisValue> > read_one_reply_unlocked(int timeout_ms);
+
+        task::Awaitable<RedisResult<void> > write_frame_unlocked(
+            const std::vector<std::uint8_t> &frame,
+            std::string_view cmd,
+            int timeout_ms);
     };
 
     static inline void normalize_auth(std::optional<std::string> &s) {
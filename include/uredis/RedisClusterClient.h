@@ -4,11 +4,15 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "uvent/Uvent.h"
@@ -18,17 +22,70 @@
 #include "uvent/utils/datastructures/queue/ConcurrentQueues.h"
 
 #include "uredis/RedisClient.h"
+#include "uredis/RedisMultiplexedConnection.h"
+#include "uredis/RedisSlot.h"
 #include "uredis/RedisTypes.h"
 
 namespace usub::uredis {
     namespace task = usub::uvent::task;
     namespace sync = usub::uvent::sync;
+    namespace system = usub::uvent::system;
 
     struct RedisClusterNode {
         std::string host;
         std::uint16_t port{6379};
     };
 
+    enum class ReadPreference {
+        Master,
+        PreferReplica,
+        ReplicaOnly,
+        Nearest
+    };
+
+    // Which nodes a cluster-wide operation runs on.
+    enum class NodeScope {
+        Masters,
+        Replicas,
+        All
+    };
+
+    struct RedisNodeReply {
+        RedisClusterNode node;
+        RedisResult<RedisValue> result;
+    };
+
+    struct RedisNodeGroup {
+        RedisClusterNode node;
+        std::vector<RedisSlotGroup> slots;
+    };
+
+    struct RedisClusterScanOptions {
+        std::string match;
+        std::size_t count{0};
+        std::string type;
+        std::size_t max_concurrency{0}; // masters scanned in parallel per step, 0 = all
+    };
+
+    // Merged cursor of a cluster-wide SCAN: one SCAN cursor per master.
+    struct RedisClusterScanCursor {
+        struct Shard {
+            RedisClusterNode node;
+            std::string cursor{"0"};
+            bool done{false};
+        };
+
+        bool started{false};
+        std::vector<Shard> shards;
+
+        [[nodiscard]] bool done() const noexcept {
+            if (!started) return false;
+            for (const auto& s: shards)
+                if (!s.done) return false;
+            return true;
+        }
+    };
+
     struct RedisClusterConfig {
         std::vector<RedisClusterNode> seeds;
 
@@ -41,15 +98,92 @@ namespace usub::uredis {
         int max_redirections{5};
         std::size_t max_connections_per_node{4};
 
+        // > 0: command() shares this many pipelined connections per node instead of checking out
+        // an exclusive pooled connection per call. Leases and fan-out stay exclusive.
+        std::size_t multiplexed_connections_per_node{0};
+        std::size_t max_inflight_per_connection{1024};
+
+        // Pool warm-up in connect(): connections opened in parallel across all nodes, and whether
+        // connect() returns once every node has one connection (the rest warm in the background).
+        std::size_t warmup_concurrency{16};
+        bool warmup_first_connection_only{false};
+
         bool force_standalone{false};
+
+        // Where read-only commands go; replica connections issue READONLY on connect.
+        ReadPreference read_preference{ReadPreference::Master};
+
+        // Background topology refresh (CLUSTER SHARDS, falling back to CLUSTER SLOTS).
+        // Triggers are coalesced into one refresh at most every min interval.
+        int topology_refresh_interval_ms{0}; // periodic trigger, 0 disables
+        int topology_min_refresh_interval_ms{1000};
+        int topology_moved_threshold{4}; // MOVED replies since the last refresh that trigger one
+
+        // Warm standby: keep a connection open to every replica and probe it with ROLE. A replica
+        // reporting itself as master takes over its former master's slots right away.
+        bool replica_standby{false};
+        int replica_standby_probe_interval_ms{250};
     };
 
     class RedisClusterClient {
+        struct Node;
+        class Impl;
+
     public:
+        using NodeCallback = std::function<
+            task::Awaitable<RedisResult<RedisValue>>(const RedisClusterNode&, RedisClient&)>;
+
+        // Exclusive use of one pooled node connection; returned to the node's pool on destruction.
+        class ClientLease {
+        public:
+            ClientLease() = default;
+            ClientLease(ClientLease&& other) noexcept;
+            ClientLease& operator=(ClientLease&& other) noexcept;
+            ClientLease(const ClientLease&) = delete;
+            ClientLease& operator=(const ClientLease&) = delete;
+            ~ClientLease();
+
+            RedisClient* operator->() const noexcept { return client_.get(); }
+            RedisClient& operator*() const noexcept { return *client_; }
+            [[nodiscard]] RedisClient* get() const noexcept { return client_.get(); }
+            explicit operator bool() const noexcept { return static_cast<bool>(client_); }
+
+            // Close the connection on release instead of returning it to the pool.
+            void mark_faulty() noexcept { faulty_ = true; }
+
+            void release() noexcept;
+
+        private:
+            friend class RedisClusterClient::Impl;
+
+            ClientLease(std::shared_ptr<Node> node, std::shared_ptr<RedisClient> client) noexcept
+                : node_(std::move(node))
+                , client_(std::move(client)) {}
+
+            std::shared_ptr<Node> node_;
+            std::shared_ptr<RedisClient> client_;
+            bool faulty_{false};
+        };
+
         explicit RedisClusterClient(RedisClusterConfig cfg);
 
+        RedisClusterClient(const RedisClusterClient&) = delete;
+        RedisClusterClient& operator=(const RedisClusterClient&) = delete;
+
+        // Does not wait: a topology refresh or standby probe still running owns the client state
+        // and releases it when done. co_await stop() to wait for them.
+        ~RedisClusterClient();
+
+        // Stops the periodic topology refresh and the replica standby probes, and waits until none
+        // of them runs. Connections are closed with the object.
+        task::Awaitable<void> stop();
+
         task::Awaitable<RedisResult<void>> connect();
 
+        task::Awaitable<RedisResult<void>> refresh_topology();
+
+        void schedule_topology_refresh();
+
         task::Awaitable<RedisResult<RedisValue>> command(
             std::string_view cmd,
             std::span<const std::string_view> args);
@@ -66,104 +200,68 @@ namespace usub::uredis {
                 std::span<const std::string_view>(arr.data(), arr.size()));
         }
 
-        task::Awaitable<RedisResult<std::shared_ptr<RedisClient>>>
+        task::Awaitable<RedisResult<ClientLease>>
         get_client_for_key(std::string_view key);
 
-        task::Awaitable<RedisResult<std::shared_ptr<RedisClient>>>
+        task::Awaitable<RedisResult<ClientLease>>
         get_any_client();
 
-        task::Awaitable<RedisResult<std::shared_ptr<RedisClient>>>
+        task::Awaitable<RedisResult<ClientLease>>
         get_client_for_slot(int slot);
 
-    private:
-        struct Node {
-            RedisConfig cfg;
-
-            usub::queue::concurrent::MPMCQueue<std::shared_ptr<RedisClient>> idle;
-            std::atomic<std::size_t> live_count{0};
-
-            sync::AsyncSemaphore idle_sem{0};
-            std::atomic<std::uint32_t> waiters{0};
-
-            Node(RedisConfig cfg_, std::size_t max_pool)
-                : cfg(std::move(cfg_))
-                , idle(max_pool) {}
-
-            void notify_waiters_if_any() noexcept {
-                if (waiters.load(std::memory_order_relaxed) > 0)
-                    idle_sem.release();
-            }
-        };
-
-        struct PooledClient {
-            std::shared_ptr<Node> node;
-            std::shared_ptr<RedisClient> client;
-        };
-
-        enum class RedirType { None, Moved, Ask };
-
-        struct Redirection {
-            RedirType type{RedirType::None};
-            int slot{-1};
-            std::string host;
-            std::uint16_t port{0};
-        };
-
-        RedisClusterConfig cfg_;
-
-        std::vector<std::shared_ptr<Node>> nodes_;
-        std::array<int, 16384> slot_to_node_{};
-        bool standalone_mode_{false};
-
-        sync::AsyncMutex mutex_;
-
-        sync::AsyncMutex init_mutex_;
-        sync::AsyncEvent init_event_{sync::Reset::Manual, false};
-        bool init_started_{false};
-        bool init_finished_{false};
-        std::optional<RedisResult<void>> init_result_;
-
-        sync::AsyncMutex rediscover_mutex_;
+        static std::vector<RedisSlotGroup> group_by_slot(std::span<const std::string_view> keys) {
+            return usub::uredis::group_by_slot(keys);
+        }
 
-        static std::string_view extract_hash_tag(std::string_view key);
-        static std::uint16_t calc_slot(std::string_view key);
-        static std::optional<Redirection> parse_redirection(const std::string& msg);
-        static bool is_slot_mapping_empty_error(const RedisError& e) noexcept;
+        // Groups keys by the master currently owning their slot, and by slot within a node.
+        task::Awaitable<RedisResult<std::vector<RedisNodeGroup>>> group_by_node(
+            std::span<const std::string_view> keys);
 
-        RedisResult<int> node_index_for_slot_locked(int slot) const;
-        RedisResult<int> node_index_for_key_locked(std::string_view key) const;
+        // Sends the commands to one node in a single pipelined write. No redirection is followed:
+        // MOVED/ASK come back as per-command errors (MOVED still updates the slot map).
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> execute_on_node(
+            const RedisClusterNode& node,
+            std::span<const RedisCommandView> cmds);
 
-        int ensure_node_locked(std::string_view host, std::uint16_t port);
+        // Master currently owning the slot.
+        task::Awaitable<RedisResult<RedisClusterNode>> master_for_slot(int slot);
 
-        void setup_standalone_locked();
-        bool has_full_slot_mapping_locked() const noexcept;
+        // Connection settings used for cluster nodes (credentials, timeouts).
+        [[nodiscard]] RedisConfig node_config(std::string_view host, std::uint16_t port) const;
 
-        task::Awaitable<RedisResult<std::shared_ptr<RedisClient>>>
-        connect_to_node(std::string_view host, std::uint16_t port);
+        [[nodiscard]] const RedisClusterConfig& config() const noexcept;
 
-        static task::Awaitable<void> warm_pool_fill_to_max(
-            const RedisClusterConfig& cfg,
-            const std::shared_ptr<Node>& node);
+        // Runs fn concurrently on every node of the scope (at most max_concurrency at a time,
+        // 0 = all), each on a pooled connection. Replies are in node order.
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> for_each_node(
+            NodeScope scope,
+            NodeCallback fn,
+            std::size_t max_concurrency = 0);
 
-        task::Awaitable<RedisResult<PooledClient>>
-        acquire_from_node(const std::shared_ptr<Node>& node);
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> for_each_master(
+            NodeCallback fn,
+            std::size_t max_concurrency = 0);
 
-        task::Awaitable<void>
-        release_pooled(PooledClient&& pc, bool faulty);
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> broadcast(
+            std::string_view cmd,
+            std::span<const std::string_view> args,
+            NodeScope scope = NodeScope::Masters);
 
-        task::Awaitable<RedisResult<PooledClient>> acquire_for_slot(int slot);
-        task::Awaitable<RedisResult<PooledClient>> acquire_for_any();
-        task::Awaitable<RedisResult<PooledClient>> acquire_for_key(std::string_view key);
+        task::Awaitable<RedisResult<int64_t>> dbsize();
+        task::Awaitable<RedisResult<void>> flushall(bool async = false);
+        task::Awaitable<RedisResult<std::vector<std::string>>> keys(std::string_view pattern);
 
-        task::Awaitable<RedisResult<void>> initial_discovery();
-        task::Awaitable<RedisResult<void>> rediscover_slots_serialized();
+        // Loads the script on masters and replicas; returns its SHA1.
+        task::Awaitable<RedisResult<std::string>> script_load(std::string_view script);
 
-        task::Awaitable<void> apply_moved(const Redirection& r);
+        // One step of a cluster-wide SCAN: advances the pending masters of the cursor in
+        // parallel and returns the merged keys. Repeat until cursor.done().
+        task::Awaitable<RedisResult<std::vector<std::string>>> scan(
+            RedisClusterScanCursor& cursor,
+            const RedisClusterScanOptions& opt = {});
 
-        task::Awaitable<RedisResult<RedisValue>> execute_ask(
-            const Redirection& r,
-            std::string_view cmd,
-            std::span<const std::string_view> args);
+    private:
+        std::shared_ptr<Impl> impl_;
     };
 } // namespace usub::uredis
 
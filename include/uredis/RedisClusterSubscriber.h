@@ -0,0 +1,118 @@
+#ifndef UREDIS_REDISCLUSTERSUBSCRIBER_H
+#define UREDIS_REDISCLUSTERSUBSCRIBER_H
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncEvent.h"
+#include "uvent/sync/AsyncMutex.h"
+
+#include "uredis/RedisClusterClient.h"
+#include "uredis/RedisSubscriber.h"
+
+namespace usub::uredis
+{
+    // Sharded pub/sub over a cluster: one SSUBSCRIBE connection per master owning subscribed
+    // channels. Subscriptions follow their slot when it moves (server-side SUNSUBSCRIBE, MOVED
+    // or a lost connection) by refreshing the topology and subscribing on the new owner.
+    class RedisClusterSubscriber
+    {
+    public:
+        using MessageCallback = RedisSubscriber::MessageCallback;
+
+        explicit RedisClusterSubscriber(RedisClusterClient& cluster);
+
+        // co_await close() first: connection readers and re-homing still use the object until
+        // it has returned.
+        ~RedisClusterSubscriber();
+
+        task::Awaitable<RedisResult<void>> ssubscribe(std::string channel, MessageCallback cb);
+        task::Awaitable<RedisResult<void>> sunsubscribe(std::string channel);
+
+        // SPUBLISH through the cluster client, i.e. to the master owning the channel's slot.
+        // Returns the number of receivers on that shard.
+        task::Awaitable<RedisResult<int64_t>> spublish(std::string_view channel, std::string_view payload);
+
+        // Closes every connection and waits until re-homing and the connection readers are done.
+        task::Awaitable<void> close();
+
+    private:
+        struct Connection
+        {
+            std::shared_ptr<RedisSubscriber> subscriber;
+            std::size_t channels{0};
+        };
+
+        struct Subscription
+        {
+            MessageCallback callback;
+            std::string node_key; // empty while being re-homed
+        };
+
+        RedisClusterClient& cluster_;
+
+        sync::AsyncMutex mutex_;
+        std::unordered_map<std::string, Connection> connections_;
+        std::unordered_map<std::string, Subscription> subscriptions_;
+        std::vector<std::shared_ptr<RedisSubscriber>> retired_;
+        bool closed_{false};
+
+        std::atomic<bool> rehome_running_{false};
+
+        // detach() and rehome() run detached and hold a ticket while they use the object; close()
+        // waits for the last one. Shared, so a callback or a sleeping task can still check it.
+        struct Background
+        {
+            std::atomic<bool> stopping{false};
+            std::atomic<int> running{0};
+            sync::AsyncEvent idle{sync::Reset::Manual, false};
+
+            bool enter() noexcept
+            {
+                this->running.fetch_add(1);
+                if (!this->stopping.load()) return true;
+                this->leave();
+                return false;
+            }
+
+            void leave() noexcept
+            {
+                if (this->running.fetch_sub(1) == 1 && this->stopping.load())
+                    this->idle.set();
+            }
+        };
+
+        std::shared_ptr<Background> bg_{std::make_shared<Background>()};
+
+        static std::string node_key(const RedisClusterNode& node);
+
+        task::Awaitable<RedisResult<std::pair<std::string, std::shared_ptr<RedisSubscriber>>>>
+        connection_for_locked(const RedisClusterNode& node);
+
+        task::Awaitable<RedisResult<void>> subscribe_locked(const std::string& channel, MessageCallback cb);
+
+        // Closes the connection and keeps it in retired_ until its reader has returned.
+        task::Awaitable<void> retire_locked(const std::string& key);
+        void prune_retired_locked();
+
+        // Marks one channel, or every channel of the connection, as needing a new home.
+        task::Awaitable<std::size_t> detach_locked(const std::string& key, const std::optional<std::string>& channel);
+
+        // Callback side of detach_locked; ignored unless `origin` still serves `key`. Runs on a
+        // ticket taken by the caller.
+        task::Awaitable<void> detach(std::string key, std::weak_ptr<RedisSubscriber> origin,
+                                     std::optional<std::string> channel);
+
+        void schedule_rehome();
+        task::Awaitable<void> rehome();
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISCLUSTERSUBSCRIBER_H
@@ -0,0 +1,87 @@
+#ifndef UREDIS_REDISGLOB_H
+#define UREDIS_REDISGLOB_H
+
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace usub::uredis
+{
+    // Redis glob rules (`*`, `?`, `[...]`, `[^...]`, `\` escapes). Allocation free.
+    bool glob_match(std::string_view pattern, std::string_view text) noexcept;
+
+    // Patterns compiled into a trie of glob tokens; one walk over a channel finds every matching
+    // pattern, with shared prefixes matched once. A value can be reported more than once when
+    // several `*` splits match.
+    class GlobTrie
+    {
+    public:
+        void insert(std::string_view pattern, std::size_t value);
+
+        [[nodiscard]] bool empty() const noexcept { return this->empty_; }
+
+        template <typename F>
+        void match(std::string_view text, F&& f) const
+        {
+            match_from(this->root_, text, 0, f);
+        }
+
+    private:
+        struct Node;
+
+        struct CharClass
+        {
+            std::string spec;
+            std::bitset<256> set;
+            std::unique_ptr<Node> next;
+        };
+
+        struct Node
+        {
+            std::vector<std::pair<char, std::unique_ptr<Node>>> literals;
+            std::vector<CharClass> classes;
+            std::unique_ptr<Node> any;
+            std::unique_ptr<Node> star;
+            std::vector<std::size_t> values;
+        };
+
+        Node root_;
+        bool empty_{true};
+
+        static Node* literal_child(Node& node, char c);
+        static std::bitset<256> compile_class(std::string_view spec);
+
+        template <typename F>
+        static void match_from(const Node& node, std::string_view text, std::size_t i, F& f)
+        {
+            if (i == text.size())
+            {
+                for (auto v : node.values) f(v);
+                if (node.star) match_from(*node.star, text, i, f);
+                return;
+            }
+
+            const char c = text[i];
+            for (const auto& [ch, next] : node.literals)
+            {
+                if (ch == c) match_from(*next, text, i + 1, f);
+            }
+            for (const auto& cc : node.classes)
+            {
+                if (cc.set.test(static_cast<unsigned char>(c))) match_from(*cc.next, text, i + 1, f);
+            }
+            if (node.any) match_from(*node.any, text, i + 1, f);
+            if (node.star)
+            {
+                for (std::size_t k = i; k <= text.size(); ++k)
+                    match_from(*node.star, text, k, f);
+            }
+        }
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISGLOB_H
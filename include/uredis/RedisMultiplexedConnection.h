@@ -0,0 +1,102 @@
+#ifndef UREDIS_REDISMULTIPLEXEDCONNECTION_H
+#define UREDIS_REDISMULTIPLEXEDCONNECTION_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncMutex.h"
+#include "uvent/sync/AsyncSemaphore.h"
+
+#include "uredis/RedisClient.h"
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis {
+    namespace sync = usub::uvent::sync;
+    namespace system = usub::uvent::system;
+
+    // One socket shared by many coroutines: requests are written back to back (concurrent
+    // writers are coalesced into one write) and replies are matched to requests in FIFO order
+    // by a reader coroutine. Not for blocking commands, MULTI/EXEC or pub/sub.
+    class RedisMultiplexedConnection {
+    public:
+        explicit RedisMultiplexedConnection(RedisConfig cfg, std::size_t max_inflight = 1024);
+
+        ~RedisMultiplexedConnection();
+
+        RedisMultiplexedConnection(const RedisMultiplexedConnection&) = delete;
+        RedisMultiplexedConnection& operator=(const RedisMultiplexedConnection&) = delete;
+
+        // Connects if there is no open connection; a closed connection is re-established.
+        task::Awaitable<RedisResult<void>> connect();
+
+        [[nodiscard]] bool connected() const noexcept;
+
+        [[nodiscard]] std::size_t inflight() const noexcept {
+            return inflight_.load(std::memory_order_relaxed);
+        }
+
+        task::Awaitable<RedisResult<RedisValue>> command(
+            std::string_view cmd,
+            std::span<const std::string_view> args);
+
+        template<typename... Args>
+        task::Awaitable<RedisResult<RedisValue>> command(std::string_view cmd, Args&&... args) {
+            std::array<std::string_view, sizeof...(Args)> arr{std::string_view{std::forward<Args>(args)}...};
+            co_return co_await this->command(cmd, std::span<const std::string_view>(arr.data(), arr.size()));
+        }
+
+        // The commands are written adjacently, with no other request in between.
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> pipeline(
+            std::span<const RedisCommandView> cmds);
+
+        // pipeline() in slices of at most max_inflight commands, for batches of independent
+        // commands of any size. Other requests may run between slices; an I/O error fails the
+        // whole call, with the earlier slices already applied.
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> pipeline_chunked(
+            std::span<const RedisCommandView> cmds);
+
+        void close() noexcept;
+
+        const RedisConfig& config() const { return config_; }
+
+    private:
+        struct Pending;
+        struct State;
+
+        RedisConfig config_;
+        std::size_t max_inflight_;
+
+        sync::AsyncSemaphore inflight_sem_;
+        std::atomic<std::size_t> inflight_{0};
+
+        sync::AsyncMutex multi_acquire_mutex_;
+
+        sync::AsyncMutex connect_mutex_;
+        std::atomic<std::shared_ptr<State>> state_;
+
+        task::Awaitable<RedisResult<std::shared_ptr<State>>> open_state();
+
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> submit(
+            std::span<const RedisCommandView> cmds);
+
+        static task::Awaitable<RedisResult<void>> handshake(State& st, const RedisConfig& cfg);
+        static task::Awaitable<RedisResult<RedisValue>> handshake_command(
+            State& st,
+            const RedisConfig& cfg,
+            std::string_view cmd,
+            std::span<const std::string_view> args);
+
+        static task::Awaitable<void> reader_loop(std::shared_ptr<State> st);
+        static task::Awaitable<void> flush(std::shared_ptr<State> st);
+        static task::Awaitable<void> shutdown_state(std::shared_ptr<State> st, std::string_view reason);
+    };
+} // namespace usub::uredis
+
+#endif // UREDIS_REDISMULTIPLEXEDCONNECTION_H
@@ -29,6 +29,8 @@ namespace usub::uredis
 
         int connect_timeout_ms{5000};
         int io_timeout_ms{5000};
+
+        std::string unix_path; // see RedisConfig::unix_path
     };
 
     class RedisPool
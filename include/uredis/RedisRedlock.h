@@ -9,6 +9,7 @@
 
 #include "uvent/Uvent.h"
 #include "uredis/RedisClient.h"
+#include "uredis/RedisScript.h"
 #include "uredis/RedisTypes.h"
 
 namespace usub::uredis
@@ -59,6 +60,9 @@ namespace usub::uredis
             std::string_view value);
 
         static std::string generate_random_value();
+
+        // compare-and-delete, called by EVALSHA
+        static const RedisScript& unlock_script();
     };
 } // namespace usub::uredis
 
@@ -0,0 +1,81 @@
+#ifndef UREDIS_REDISROUTER_H
+#define UREDIS_REDISROUTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncMutex.h"
+
+#include "uredis/RedisSubscriber.h"
+
+namespace usub::uredis
+{
+    // In-process fan-out on top of one RedisSubscriber: any number of local handlers share one
+    // server subscription per channel / upstream pattern (SUBSCRIBE on the first handler,
+    // UNSUBSCRIBE after the last one). Local glob patterns are matched in process by a trie, so one
+    // broad PSUBSCRIBE can serve many narrow local patterns. Handlers run lock-free on the
+    // subscriber's dispatch path.
+    //
+    // The router owns the channels and patterns it subscribes on the subscriber; do not subscribe
+    // them directly on the same subscriber.
+    class RedisRouter
+    {
+    public:
+        using Handler = RedisSubscriber::MessageViewCallback;
+        using HandlerId = std::uint64_t;
+
+        explicit RedisRouter(std::shared_ptr<RedisSubscriber> subscriber);
+
+        task::Awaitable<RedisResult<HandlerId>> on_channel(std::string channel, Handler handler);
+
+        // `pattern` is a Redis glob matched locally against channels delivered by the `upstream`
+        // PSUBSCRIBE (e.g. local "orders.eu.*" served by upstream "orders.*"). An empty upstream
+        // subscribes the pattern itself.
+        task::Awaitable<RedisResult<HandlerId>> on_pattern(std::string pattern,
+                                                          Handler handler,
+                                                          std::string upstream = {});
+
+        task::Awaitable<RedisResult<void>> remove(HandlerId id);
+
+        // Same matching rules as Redis (`*`, `?`, `[...]`, `[^...]`, `\` escapes).
+        static bool glob_match(std::string_view pattern, std::string_view text);
+
+    private:
+        struct ChannelRoute
+        {
+            std::atomic<std::shared_ptr<const std::vector<std::pair<HandlerId, Handler>>>> handlers;
+        };
+
+        struct PatternSnapshot;
+
+        struct PatternRoute
+        {
+            std::unordered_map<HandlerId, std::pair<std::string, Handler>> locals;
+            std::atomic<std::shared_ptr<const PatternSnapshot>> snapshot;
+        };
+
+        struct Entry
+        {
+            bool pattern{false};
+            std::string key; // channel, or upstream pattern
+        };
+
+        std::shared_ptr<RedisSubscriber> subscriber_;
+
+        sync::AsyncMutex mutex_;
+        HandlerId next_id_{0};
+        std::unordered_map<HandlerId, Entry> entries_;
+        std::unordered_map<std::string, std::shared_ptr<ChannelRoute>> channels_;
+        std::unordered_map<std::string, std::shared_ptr<PatternRoute>> patterns_;
+
+        static void rebuild(PatternRoute& route);
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISROUTER_H
@@ -0,0 +1,124 @@
+#ifndef UREDIS_REDISSCAN_H
+#define UREDIS_REDISSCAN_H
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncEvent.h"
+
+#include "uredis/RedisClusterClient.h"
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis
+{
+    namespace task = usub::uvent::task;
+    namespace sync = usub::uvent::sync;
+
+    struct RedisScanOptions
+    {
+        std::string match;
+        std::size_t count{0};
+        std::string type;     // SCAN only
+        bool prefetch{true};  // request the next page while the caller works on this one
+    };
+
+    // One page of a SCAN-family reply. Elements are views into `reply`: keys (SCAN) or members
+    // (SSCAN), or field/value (HSCAN) and member/score (ZSCAN) pairs.
+    struct RedisScanPage
+    {
+        RedisValue reply;
+        std::span<const RedisValue> items;
+
+        [[nodiscard]] std::size_t size() const noexcept { return this->items.size(); }
+        [[nodiscard]] bool empty() const noexcept { return this->items.empty(); }
+        [[nodiscard]] std::string_view operator[](std::size_t i) const { return this->items[i].as_string(); }
+
+        [[nodiscard]] std::size_t pair_count() const noexcept { return this->items.size() / 2; }
+        [[nodiscard]] std::pair<std::string_view, std::string_view> pair(std::size_t i) const
+        {
+            return {this->items[2 * i].as_string(), this->items[2 * i + 1].as_string()};
+        }
+    };
+
+    // Pages through SCAN / HSCAN / SSCAN / ZSCAN. With prefetch on, the request for the next
+    // cursor is in flight while the caller processes the page next() returned, so a scan costs
+    // about max(RTT, processing) per page instead of their sum. The connection must tolerate
+    // that concurrent request: use a RedisPool, RedisMultiplexedConnection or the cluster client,
+    // or a RedisClient the caller does not touch during the scan.
+    //
+    //     auto it = RedisScanIterator::scan(pool, {.match = "session:*", .count = 1000});
+    //     while (auto page = co_await it.next()) {
+    //         if (!*page) break;
+    //         for (std::size_t i = 0; i < (*page)->size(); ++i) use((**page)[i]);
+    //     }
+    class RedisScanIterator
+    {
+    public:
+        // nullopt once the scan is complete; empty pages are skipped. After an error the same
+        // cursor is retried on the next call.
+        task::Awaitable<std::optional<RedisResult<RedisScanPage>>> next();
+
+        [[nodiscard]] bool done() const noexcept;
+
+        template <typename Conn>
+        static RedisScanIterator scan(std::shared_ptr<Conn> conn, RedisScanOptions opt = {})
+        {
+            return RedisScanIterator(bind(std::move(conn)), "SCAN", {}, std::move(opt));
+        }
+
+        template <typename Conn>
+        static RedisScanIterator hscan(std::shared_ptr<Conn> conn, std::string key, RedisScanOptions opt = {})
+        {
+            return RedisScanIterator(bind(std::move(conn)), "HSCAN", std::move(key), std::move(opt));
+        }
+
+        template <typename Conn>
+        static RedisScanIterator sscan(std::shared_ptr<Conn> conn, std::string key, RedisScanOptions opt = {})
+        {
+            return RedisScanIterator(bind(std::move(conn)), "SSCAN", std::move(key), std::move(opt));
+        }
+
+        template <typename Conn>
+        static RedisScanIterator zscan(std::shared_ptr<Conn> conn, std::string key, RedisScanOptions opt = {})
+        {
+            return RedisScanIterator(bind(std::move(conn)), "ZSCAN", std::move(key), std::move(opt));
+        }
+
+        // Every master, through RedisClusterClient::scan(): one cursor per master, all advanced
+        // in parallel per page. HSCAN/SSCAN/ZSCAN on a cluster use the templates above (the key
+        // routes them).
+        static RedisScanIterator scan(std::shared_ptr<RedisClusterClient> cluster, RedisScanOptions opt = {});
+
+    private:
+        using Command = std::function<task::Awaitable<RedisResult<RedisValue>>(
+            std::string_view cmd, std::span<const std::string_view> args)>;
+
+        struct State;
+
+        std::shared_ptr<State> st_;
+
+        RedisScanIterator(Command command, std::string_view cmd, std::string key, RedisScanOptions opt);
+
+        template <typename Conn>
+        static Command bind(std::shared_ptr<Conn> conn)
+        {
+            return [conn = std::move(conn)](std::string_view cmd, std::span<const std::string_view> args)
+            {
+                return conn->command(cmd, args);
+            };
+        }
+
+        static void start_fetch(const std::shared_ptr<State>& st);
+        static task::Awaitable<void> fetch(std::shared_ptr<State> st);
+        static task::Awaitable<RedisResult<RedisScanPage>> fetch_cursor(State& st);
+        static task::Awaitable<RedisResult<RedisScanPage>> fetch_cluster(State& st);
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISSCAN_H
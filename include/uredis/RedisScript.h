@@ -0,0 +1,87 @@
+#ifndef UREDIS_REDISSCRIPT_H
+#define UREDIS_REDISSCRIPT_H
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis
+{
+    namespace task = usub::uvent::task;
+
+    class RedisClusterClient;
+
+    // A Lua script called by SHA1: EVALSHA on every call, and on NOSCRIPT (cache flushed, new
+    // master after failover, ...) SCRIPT LOAD on the same connection and one retry. The SHA1 is
+    // computed locally, so nothing is sent until the first call.
+    //
+    // Conn is anything with command(cmd, span<const string_view>) talking to one server:
+    // RedisClient, RedisPool, RedisSentinelPool, RedisMultiplexedConnection. Cluster calls run
+    // on a lease of the node owning the first key.
+    class RedisScript
+    {
+    public:
+        explicit RedisScript(std::string source);
+
+        [[nodiscard]] const std::string& source() const noexcept { return this->source_; }
+        [[nodiscard]] const std::string& sha1() const noexcept { return this->sha1_; }
+
+        // lower-case hex, as returned by SCRIPT LOAD
+        static std::string sha1_hex(std::string_view data);
+
+        template <typename Conn>
+        task::Awaitable<RedisResult<RedisValue>> eval(
+            Conn& conn,
+            std::span<const std::string_view> keys,
+            std::span<const std::string_view> args) const
+        {
+            const auto numkeys = std::to_string(keys.size());
+            const auto frame = this->evalsha_args(numkeys, keys, args);
+            const auto view = std::span<const std::string_view>(frame);
+
+            auto r = co_await conn.command("EVALSHA", view);
+            if (r || !is_noscript(r.error())) co_return r;
+
+            auto l = co_await this->load(conn);
+            if (!l) co_return std::unexpected(l.error());
+
+            co_return co_await conn.command("EVALSHA", view);
+        }
+
+        template <typename Conn>
+        task::Awaitable<RedisResult<void>> load(Conn& conn) const
+        {
+            const std::string_view args[2] = {"LOAD", this->source_};
+            auto r = co_await conn.command("SCRIPT", std::span<const std::string_view>(args, 2));
+            if (!r) co_return std::unexpected(r.error());
+            co_return this->check_loaded(*r);
+        }
+
+        task::Awaitable<RedisResult<RedisValue>> eval(
+            RedisClusterClient& cluster,
+            std::span<const std::string_view> keys,
+            std::span<const std::string_view> args) const;
+
+        // SCRIPT LOAD on every master and replica
+        task::Awaitable<RedisResult<void>> load(RedisClusterClient& cluster) const;
+
+    private:
+        std::string source_;
+        std::string sha1_;
+
+        std::vector<std::string_view> evalsha_args(
+            std::string_view numkeys,
+            std::span<const std::string_view> keys,
+            std::span<const std::string_view> args) const;
+
+        RedisResult<void> check_loaded(const RedisValue& reply) const;
+
+        static bool is_noscript(const RedisError& err) noexcept;
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISSCRIPT_H
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <optional>
 
@@ -20,6 +21,8 @@ namespace usub::uredis
 
         std::optional<std::string> username;
         std::optional<std::string> password;
+
+        std::string unix_path; // non-empty: reach this sentinel over a Unix socket
     };
 
     struct RedisSentinelConfig
@@ -32,6 +35,10 @@ namespace usub::uredis
         int io_timeout_ms{3000};
 
         RedisConfig base_redis{};
+
+        // "host:port" as announced by the sentinels -> Unix socket of that server on this host.
+        // A resolved master found here is connected over the socket; others use TCP.
+        std::unordered_map<std::string, std::string> local_sockets;
     };
 
     task::Awaitable<RedisResult<RedisConfig>>
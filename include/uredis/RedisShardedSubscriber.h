@@ -0,0 +1,130 @@
+#ifndef UREDIS_REDISSHARDEDSUBSCRIBER_H
+#define UREDIS_REDISSHARDEDSUBSCRIBER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncEvent.h"
+#include "uvent/sync/AsyncMutex.h"
+
+#include "uredis/RedisSubscriber.h"
+
+namespace usub::uredis
+{
+    // Spreads channels over N subscriber connections, each with its own reader coroutine and
+    // parser, so inbound throughput is not capped by one socket. Channels are placed by hash,
+    // patterns by Config::pattern_shards or by hash. Every connection reconnects and resubscribes
+    // on its own; the others keep delivering meanwhile.
+    class RedisShardedSubscriber
+    {
+    public:
+        using MessageCallback = RedisSubscriber::MessageCallback;
+        using MessageViewCallback = RedisSubscriber::MessageViewCallback;
+
+        struct Config
+        {
+            RedisConfig redis;
+            std::size_t connections{0}; // 0: one per hardware thread
+            int reconnect_delay_ms{1000};
+
+            RedisSubscriber::DispatchOptions dispatch;
+
+            // pattern -> connection index; other patterns are placed by hash
+            std::unordered_map<std::string, std::size_t> pattern_shards;
+
+            std::function<void(const RedisError&)> on_error;
+        };
+
+        explicit RedisShardedSubscriber(Config cfg);
+
+        // co_await close() first: connection readers and reconnect loops still use the object
+        // until it has returned.
+        ~RedisShardedSubscriber();
+
+        // Connects every shard. Subscribing also connects its shard on demand.
+        task::Awaitable<RedisResult<void>> connect();
+
+        task::Awaitable<RedisResult<void>> subscribe(std::string channel, MessageCallback cb);
+        task::Awaitable<RedisResult<void>> subscribe_view(std::string channel, MessageViewCallback cb);
+        task::Awaitable<RedisResult<void>> psubscribe(std::string pattern, MessageCallback cb);
+        task::Awaitable<RedisResult<void>> psubscribe_view(std::string pattern, MessageViewCallback cb);
+
+        task::Awaitable<RedisResult<void>> unsubscribe(std::string channel);
+        task::Awaitable<RedisResult<void>> punsubscribe(std::string pattern);
+
+        std::size_t shard_count() const { return this->shards_.size(); }
+        std::size_t shard_of_channel(std::string_view channel) const;
+        std::size_t shard_of_pattern(std::string_view pattern) const;
+
+        // Closes every connection and waits until reconnects and the connection readers are done.
+        task::Awaitable<void> close();
+
+    private:
+        using Subscription = RedisSubscriber::Subscription;
+
+        struct Shard
+        {
+            std::size_t index{0};
+            sync::AsyncMutex mutex;
+
+            std::shared_ptr<RedisSubscriber> subscriber;
+            std::vector<std::shared_ptr<RedisSubscriber>> retired;
+
+            std::unordered_map<std::string, Subscription> channels;
+            std::unordered_map<std::string, Subscription> patterns;
+
+            std::atomic<bool> reconnecting{false};
+        };
+
+        Config cfg_;
+        std::vector<std::unique_ptr<Shard>> shards_;
+        std::atomic<bool> closed_{false};
+
+        // Reconnect loops and close callbacks hold a ticket while they use the object and drop it
+        // while sleeping; close() waits for the last one. Shared, so a sleeping loop can check it.
+        struct Background
+        {
+            std::atomic<bool> stopping{false};
+            std::atomic<int> running{0};
+            sync::AsyncEvent idle{sync::Reset::Manual, false};
+
+            bool enter() noexcept
+            {
+                this->running.fetch_add(1);
+                if (!this->stopping.load()) return true;
+                this->leave();
+                return false;
+            }
+
+            void leave() noexcept
+            {
+                if (this->running.fetch_sub(1) == 1 && this->stopping.load())
+                    this->idle.set();
+            }
+        };
+
+        std::shared_ptr<Background> bg_{std::make_shared<Background>()};
+
+        task::Awaitable<RedisResult<void>> connect_shard_locked(Shard& shard);
+
+        // Keeps a closed connection in shard.retired until its reader has returned.
+        static void retire_locked(Shard& shard, std::shared_ptr<RedisSubscriber> sub);
+        static void prune_retired_locked(Shard& shard);
+
+        task::Awaitable<RedisResult<void>> add(Shard& shard, bool pattern, Subscription sub);
+        task::Awaitable<RedisResult<void>> remove(Shard& shard, bool pattern, std::string name);
+
+        void schedule_reconnect(Shard& shard);
+        task::Awaitable<void> reconnect(Shard& shard);
+
+        void notify_error(const RedisError& err) const;
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISSHARDEDSUBSCRIBER_H
@@ -0,0 +1,39 @@
+#ifndef UREDIS_REDISSLOT_H
+#define UREDIS_REDISSLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace usub::uredis {
+    inline constexpr int cluster_slot_count = 16384;
+
+    // CRC16-CCITT (XMODEM), the checksum Redis Cluster uses for key hashing.
+    std::uint16_t crc16(std::string_view data) noexcept;
+
+    // Portable slice-by-8 implementation; crc16() dispatches to a carry-less
+    // multiply variant for long inputs when built with UREDIS_CRC16_PCLMUL.
+    std::uint16_t crc16_slice8(std::string_view data) noexcept;
+
+    // Returns the `{...}` hash tag of the key, or the whole key when there is none.
+    std::string_view hash_tag(std::string_view key) noexcept;
+
+    std::uint16_t slot_of(std::string_view key) noexcept;
+
+    // out.size() must be >= keys.size().
+    void slots_of(std::span<const std::string_view> keys, std::span<std::uint16_t> out) noexcept;
+
+    std::vector<std::uint16_t> slots_of(std::span<const std::string_view> keys);
+
+    struct RedisSlotGroup {
+        std::uint16_t slot{0};
+        std::vector<std::size_t> indices; // positions in the input key span, ascending
+    };
+
+    // Groups keys by slot; groups are ordered by slot.
+    std::vector<RedisSlotGroup> group_by_slot(std::span<const std::string_view> keys);
+} // namespace usub::uredis
+
+#endif // UREDIS_REDISSLOT_H
@@ -0,0 +1,150 @@
+#ifndef UREDIS_REDISSTREAMBUS_H
+#define UREDIS_REDISSTREAMBUS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncEvent.h"
+#include "uvent/sync/AsyncMutex.h"
+#include "uredis/RedisBus.h"
+#include "uredis/RedisClient.h"
+#include "uredis/RedisMultiplexedConnection.h"
+#include "uredis/RedisStreams.h"
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis
+{
+    // RedisBus with the same publish/subscribe shape, carried by Redis Streams and a consumer
+    // group instead of pub/sub: every channel is a stream, messages published while a consumer
+    // is away are kept (up to Config::maxlen) and delivered when it is back. Delivery is
+    // at-least-once: an entry is acknowledged after its handler returns, and entries left
+    // unacknowledged for claim_min_idle_ms by a dead consumer are claimed by a live one.
+    class RedisStreamBus
+    {
+    public:
+        using Callback = RedisBus::Callback;
+
+        struct Config
+        {
+            RedisConfig redis;
+
+            std::string group{"uredis"};
+            // Stable names let a restarted consumer resume its own pending entries; empty means
+            // a random name per instance.
+            std::string consumer;
+            std::string key_prefix; // stream key = key_prefix + channel
+
+            // XADD ... MAXLEN ~ maxlen; 0 disables trimming
+            std::size_t maxlen{100000};
+
+            std::size_t publish_connections{1};
+            std::size_t max_inflight_per_publisher{1024};
+
+            std::size_t read_count{128};
+            int block_ms{2000};
+
+            int claim_min_idle_ms{30000};
+            int claim_interval_ms{5000};
+
+            int reconnect_delay_ms{2000};
+
+            std::function<void(const RedisError&)> on_error;
+        };
+
+        explicit RedisStreamBus(Config cfg);
+
+        // Read loop: XREADGROUP on a dedicated connection, handlers, batched XACK and periodic
+        // XAUTOCLAIM. Returns after close().
+        task::Awaitable<void> run();
+
+        // XADD over the multiplexed publish connections; concurrent publishes are pipelined.
+        task::Awaitable<RedisResult<void>> publish(
+            std::string_view channel,
+            std::string_view payload);
+
+        void publish_detached(std::string channel, std::string payload);
+
+        // Creates the consumer group (and the stream) if missing. New messages only: entries
+        // added before the group existed are not delivered.
+        task::Awaitable<RedisResult<void>> subscribe(
+            std::string channel,
+            Callback cb);
+
+        task::Awaitable<RedisResult<void>> subscribe(
+            std::span<const std::string> channels,
+            Callback cb);
+
+        // Stops reading the stream; the group and its pending entries stay on the server.
+        task::Awaitable<RedisResult<void>> unsubscribe(std::string channel);
+
+        // Stops the read loop after the current read (at most block_ms) and flushes its acks.
+        task::Awaitable<void> close();
+
+        const std::string& consumer() const { return this->consumer_; }
+
+    private:
+        struct Stream
+        {
+            std::string channel;
+            Callback cb;
+        };
+
+        // stream key -> subscription
+        using Streams = std::unordered_map<std::string, Stream>;
+
+        struct Acks
+        {
+            std::unordered_map<std::string, std::vector<std::string>> ids; // stream key -> ids
+            std::size_t count{0};
+        };
+
+        Config cfg_;
+        std::string consumer_;
+        std::string maxlen_;
+
+        std::vector<std::shared_ptr<RedisMultiplexedConnection>> publishers_;
+        std::shared_ptr<RedisClient> reader_;
+
+        sync::AsyncMutex mutex_;
+        Streams desired_;
+        std::atomic<std::shared_ptr<const Streams>> streams_;
+
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> running_{false};
+        sync::AsyncEvent stopped_{sync::Reset::Manual, false};
+
+        std::string stream_key(std::string_view channel) const;
+        std::shared_ptr<RedisMultiplexedConnection> pick_publisher() const;
+
+        task::Awaitable<RedisResult<void>> ensure_groups(std::span<const std::string> keys);
+
+        // true when a new reader connection was opened
+        task::Awaitable<RedisResult<bool>> ensure_reader();
+        task::Awaitable<RedisResult<bool>> read_batch(const Streams& streams, bool pending, Acks& acks);
+        task::Awaitable<void> on_read_error(const RedisError& err, const Streams& streams);
+        task::Awaitable<void> claim_stuck(const Streams& streams, Acks& acks);
+        task::Awaitable<void> flush_acks(Acks& acks);
+
+        void dispatch(const Stream& stream, const std::string& key, const RedisValue& entries, Acks& acks) const;
+
+        static task::Awaitable<void> publish_task(
+            std::shared_ptr<RedisMultiplexedConnection> pub,
+            std::string key,
+            std::string maxlen,
+            std::string payload,
+            std::function<void(const RedisError&)> on_error);
+
+        void notify_error(const RedisError& err) const;
+    };
+} // namespace usub::uredis
+
+#endif // UREDIS_REDISSTREAMBUS_H
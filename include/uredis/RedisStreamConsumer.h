@@ -0,0 +1,120 @@
+#ifndef UREDIS_REDISSTREAMCONSUMER_H
+#define UREDIS_REDISSTREAMCONSUMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "uvent/Uvent.h"
+#include "uvent/sync/AsyncEvent.h"
+
+#include "uredis/RedisClient.h"
+#include "uredis/RedisMultiplexedConnection.h"
+#include "uredis/RedisStreams.h"
+
+namespace usub::uredis
+{
+    namespace task = usub::uvent::task;
+    namespace sync = usub::uvent::sync;
+
+    // Consumer-group runner for job streams. Each round reads up to batch_size entries with one
+    // XREADGROUP, runs the handler on them with up to `concurrency` coroutines, and acknowledges
+    // the handled ones with one pipelined XACK per stream. Entries the handler rejects stay
+    // pending; entries idle in the PEL for claim_min_idle_ms (this or a dead consumer) are taken
+    // over with XAUTOCLAIM and handled again.
+    class RedisStreamConsumer
+    {
+    public:
+        // true: acknowledge the entry; false: leave it pending for a later retry
+        using Handler = std::function<task::Awaitable<bool>(std::string_view stream, const StreamEntry& entry)>;
+
+        struct Config
+        {
+            RedisConfig redis;
+
+            std::vector<std::string> streams;
+            std::string group;
+            std::string consumer; // empty: random name per instance
+
+            bool create_group{true}; // XGROUP CREATE <stream> <group> <start_id> MKSTREAM
+            std::string start_id{"$"};
+
+            std::size_t batch_size{128};
+            std::size_t concurrency{1};
+            int block_ms{2000};
+
+            int claim_min_idle_ms{30000};
+            int claim_interval_ms{5000};
+
+            int metrics_interval_ms{5000}; // XINFO GROUPS for lag / pending, 0 disables
+            int reconnect_delay_ms{2000};
+
+            std::function<void(const RedisError&)> on_error;
+        };
+
+        struct Stats
+        {
+            std::uint64_t delivered{0};
+            std::uint64_t acked{0};
+            std::uint64_t rejected{0};
+            std::uint64_t claimed{0};
+
+            // from XINFO GROUPS, summed over the streams; -1 until known (lag needs Redis 7)
+            std::int64_t lag{-1};
+            std::int64_t pending{-1};
+        };
+
+        RedisStreamConsumer(Config cfg, Handler handler);
+
+        // Runs until close().
+        task::Awaitable<void> run();
+
+        // Stops after the current batch (at most block_ms) and waits for run() to return.
+        task::Awaitable<void> close();
+
+        Stats stats() const;
+
+    private:
+        struct Batch;
+
+        Config cfg_;
+        Handler handler_;
+
+        std::shared_ptr<RedisClient> reader_;
+        RedisMultiplexedConnection control_;
+
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> running_{false};
+        sync::AsyncEvent stopped_{sync::Reset::Manual, false};
+
+        std::atomic<std::uint64_t> delivered_{0};
+        std::atomic<std::uint64_t> acked_{0};
+        std::atomic<std::uint64_t> rejected_{0};
+        std::atomic<std::uint64_t> claimed_{0};
+        std::atomic<std::int64_t> lag_{-1};
+        std::atomic<std::int64_t> pending_{-1};
+
+        task::Awaitable<RedisResult<void>> create_groups();
+        task::Awaitable<RedisResult<bool>> ensure_reader();
+
+        // pending_from: per stream, read own pending entries after that id and advance it past
+        // the last entry returned; null reads new entries (`>`).
+        task::Awaitable<RedisResult<bool>> read_round(std::vector<std::string>* pending_from);
+        task::Awaitable<void> claim_round();
+        task::Awaitable<void> refresh_metrics();
+
+        task::Awaitable<void> process(std::shared_ptr<Batch> batch);
+        task::Awaitable<void> ack(const Batch& batch);
+
+        static task::Awaitable<void> worker(std::shared_ptr<Batch> batch, const Handler* handler,
+                                            std::size_t first, std::size_t step);
+
+        void notify_error(const RedisError& err) const;
+    };
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISSTREAMCONSUMER_H
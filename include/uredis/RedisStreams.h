@@ -0,0 +1,60 @@
+#ifndef UREDIS_REDISSTREAMS_H
+#define UREDIS_REDISSTREAMS_H
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis
+{
+    // Decoded views over Stream replies (XREAD, XREADGROUP, XRANGE, XAUTOCLAIM). Nothing is
+    // copied: ids, fields and values point into the RedisValue the reply was decoded from, which
+    // must outlive them.
+    struct StreamEntry
+    {
+        std::string_view id;
+        std::span<const RedisValue> raw; // field, value, field, value, ...
+        bool deleted{false};             // pending entry trimmed from the stream: no fields
+
+        [[nodiscard]] std::size_t field_count() const { return this->raw.size() / 2; }
+        [[nodiscard]] std::string_view field(std::size_t i) const { return this->raw[2 * i].as_string(); }
+        [[nodiscard]] std::string_view value(std::size_t i) const { return this->raw[2 * i + 1].as_string(); }
+
+        // first value of `name`
+        [[nodiscard]] std::optional<std::string_view> get(std::string_view name) const
+        {
+            for (std::size_t i = 0; i < this->field_count(); ++i)
+            {
+                if (this->field(i) == name) return this->value(i);
+            }
+            return std::nullopt;
+        }
+    };
+
+    struct StreamRead
+    {
+        std::string_view stream;
+        std::vector<StreamEntry> entries;
+    };
+
+    struct StreamClaim
+    {
+        std::string_view next;               // cursor for the next call, "0-0" when done
+        std::vector<StreamEntry> entries;
+        std::vector<std::string_view> deleted; // ids dropped from the PEL (Redis 7+)
+    };
+
+    // Entry array of XRANGE / XREVRANGE / one stream of XREAD.
+    RedisResult<std::vector<StreamEntry>> decode_stream_entries(const RedisValue& entries);
+
+    // XREAD / XREADGROUP; a null reply (BLOCK timed out) is an empty result.
+    RedisResult<std::vector<StreamRead>> decode_stream_read(const RedisValue& reply);
+
+    RedisResult<StreamClaim> decode_stream_claim(const RedisValue& reply);
+} // namespace usub::uredis
+
+#endif //UREDIS_REDISSTREAMS_H
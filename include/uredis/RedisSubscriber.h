@@ -1,6 +1,9 @@
 #ifndef REDISSUBSCRIBER_H
 #define REDISSUBSCRIBER_H
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -31,17 +34,73 @@ namespace usub::uredis
     public:
         using MessageCallback = std::function<void(const std::string& channel,
                                                    const std::string& payload)>;
+        // Zero-copy handler: the views point into the read buffer and are only valid during the call.
+        using MessageViewCallback = std::function<void(std::string_view channel,
+                                                       std::string_view payload)>;
+        using ChannelEventCallback = std::function<void(const std::string& channel)>;
+        using CloseCallback = std::function<void()>;
+
+        struct Subscription
+        {
+            std::string name; // channel or pattern
+            MessageCallback callback{};
+            MessageViewCallback view_callback{}; // used instead of callback when set
+        };
+
+        enum class OverflowPolicy { DropNewest, DropOldest, Block };
+
+        // queue_capacity > 0: every subscription gets a bounded queue drained by its own worker
+        // coroutine, so handlers never run on the reader. Block stops reading from the socket
+        // while the queue is full. 0 (default): handlers run inline on the reader.
+        struct DispatchOptions
+        {
+            std::size_t queue_capacity{0};
+            OverflowPolicy overflow{OverflowPolicy::DropNewest};
+        };
+
+        struct DispatchStats
+        {
+            std::string name; // channel or pattern
+            std::size_t depth{0};
+            std::uint64_t delivered{0};
+            std::uint64_t dropped{0};
+        };
 
         explicit RedisSubscriber(RedisConfig cfg);
+        RedisSubscriber(RedisConfig cfg, DispatchOptions dispatch);
 
         task::Awaitable<RedisResult<void>> connect();
 
         task::Awaitable<RedisResult<void>> subscribe(std::string channel, MessageCallback cb);
         task::Awaitable<RedisResult<void>> psubscribe(std::string pattern, MessageCallback cb);
 
+        // Bulk variants: every name goes out in one write (multi-argument frames of up to
+        // max_names_per_frame names each) and the call completes once all confirmations arrived.
+        // Returns the first error; names confirmed before it stay subscribed.
+        task::Awaitable<RedisResult<void>> subscribe(std::span<const Subscription> channels);
+        task::Awaitable<RedisResult<void>> psubscribe(std::span<const Subscription> patterns);
+        task::Awaitable<RedisResult<void>> subscribe(std::span<const std::string> channels, MessageCallback cb);
+        task::Awaitable<RedisResult<void>> psubscribe(std::span<const std::string> patterns, MessageCallback cb);
+
+        static constexpr std::size_t max_names_per_frame = 1024;
+
+        task::Awaitable<RedisResult<void>> subscribe_view(std::string channel, MessageViewCallback cb);
+        task::Awaitable<RedisResult<void>> psubscribe_view(std::string pattern, MessageViewCallback cb);
+
         task::Awaitable<RedisResult<void>> unsubscribe(std::string channel);
         task::Awaitable<RedisResult<void>> punsubscribe(std::string pattern);
 
+        // Sharded pub/sub (Redis 7+). The connection must point at the master owning the
+        // channel's slot; otherwise the returned error carries the MOVED redirection.
+        task::Awaitable<RedisResult<void>> ssubscribe(std::string channel, MessageCallback cb);
+        task::Awaitable<RedisResult<void>> ssubscribe_view(std::string channel, MessageViewCallback cb);
+        task::Awaitable<RedisResult<void>> sunsubscribe(std::string channel);
+
+        // Called from the reader when the server drops a shard subscription on its own
+        // (slot migrated away) and when the connection closes without close().
+        void set_sunsubscribe_callback(ChannelEventCallback cb);
+        void set_close_callback(CloseCallback cb);
+
         task::Awaitable<void> close();
 
         inline bool is_connected() const
@@ -49,14 +108,53 @@ namespace usub::uredis
             return this->connected_ && !this->closing_;
         }
 
+        // True while the reader coroutine runs; until it returns the object must stay alive.
+        inline bool reader_running() const
+        {
+            return this->reader_running_.load(std::memory_order_acquire);
+        }
+
+        // One entry per subscription with a dispatch queue.
+        std::vector<DispatchStats> dispatch_stats() const;
+
     private:
+        struct DispatchQueue;
+
+        struct Handler
+        {
+            MessageCallback owned{};
+            MessageViewCallback view{};
+            std::shared_ptr<DispatchQueue> queue{};
+
+            void operator()(std::string_view channel, std::string_view payload) const
+            {
+                if (this->view)
+                    this->view(channel, payload);
+                else if (this->owned)
+                    this->owned(std::string(channel), std::string(payload));
+            }
+        };
+
+        // transparent hash: handlers are looked up by string_view into the read buffer
+        struct NameHash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view s) const noexcept
+            {
+                return std::hash<std::string_view>{}(s);
+            }
+        };
+
+        using HandlerMap = std::unordered_map<std::string, Handler, NameHash, std::equal_to<>>;
+
         struct PendingSub
         {
             sync::AsyncEvent event{sync::Reset::Manual, false};
             RedisResult<void> result{
                 std::unexpected(RedisError{RedisErrorCategory::Protocol, "uninitialized"})
             };
-            MessageCallback callback;
+            Handler callback;
         };
 
         struct PendingUnsub
@@ -68,10 +166,12 @@ namespace usub::uredis
         };
 
         RedisConfig config_;
+        DispatchOptions dispatch_;
 
-        net::TCPClientSocket socket_{};
+        std::shared_ptr<net::TCPClientSocket> socket_{};
         bool connected_{false};
         bool closing_{false};
+        std::atomic<bool> reader_running_{false};
 
         RespParser parser_{};
 
@@ -81,17 +181,46 @@ namespace usub::uredis
         std::unordered_map<std::string, std::shared_ptr<PendingSub>> pending_psub_;
         std::unordered_map<std::string, std::shared_ptr<PendingUnsub>> pending_unsub_;
         std::unordered_map<std::string, std::shared_ptr<PendingUnsub>> pending_punsub_;
+        std::unordered_map<std::string, std::shared_ptr<PendingSub>> pending_ssub_;
+        std::unordered_map<std::string, std::shared_ptr<PendingUnsub>> pending_sunsub_;
+
+        // SSUBSCRIBE order, so that an error reply can be matched to its request
+        std::deque<std::string> ssub_order_;
+
+        HandlerMap channel_handlers_;
+        HandlerMap pattern_handlers_;
+        HandlerMap shard_handlers_;
 
-        std::unordered_map<std::string, MessageCallback> channel_handlers_;
-        std::unordered_map<std::string, MessageCallback> pattern_handlers_;
+        ChannelEventCallback on_sunsubscribe_;
+        CloseCallback on_close_;
 
         task::Awaitable<void> reader_loop();
 
+        task::Awaitable<RedisResult<void>> subscribe_many(
+            std::string_view cmd,
+            std::unordered_map<std::string, std::shared_ptr<PendingSub>>& pending,
+            std::span<const Subscription> subs);
+
         static std::vector<uint8_t> encode_command(
             std::string_view cmd,
             std::span<const std::string_view> args);
 
+        task::Awaitable<RedisResult<void>> ssubscribe_handler(std::string channel, Handler handler);
+
+        // Returns the queue when the message has to wait for space (OverflowPolicy::Block).
+        std::shared_ptr<DispatchQueue> dispatch_push(const RespParser::PushMessage& m);
+
+        void set_handler(HandlerMap& map, const std::string& name, Handler handler);
+        static bool erase_handler(HandlerMap& map, const std::string& name);
+        void stop_queues();
+
+        static task::Awaitable<void> push_blocking(std::shared_ptr<DispatchQueue> q,
+                                                   std::string_view channel,
+                                                   std::string_view payload);
+        static task::Awaitable<void> dispatch_worker(std::shared_ptr<DispatchQueue> q);
+
         void handle_array(RedisValue&& v);
+        void handle_error(const std::string& msg);
         void fail_all(RedisErrorCategory cat, std::string_view msg);
     };
 } // namespace usub::uredis
@@ -0,0 +1,82 @@
+#ifndef UREDIS_REDISTRANSACTION_H
+#define UREDIS_REDISTRANSACTION_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "uvent/Uvent.h"
+
+#include "uredis/RedisClient.h"
+#include "uredis/RedisTypes.h"
+
+namespace usub::uredis {
+    namespace task = usub::uvent::task;
+
+    struct RedisWatchOptions {
+        int max_attempts{16};
+        int backoff_initial_ms{1}; // doubled after every aborted EXEC
+        int backoff_max_ms{100};
+    };
+
+    // MULTI, the queued commands and EXEC written as one pipeline: one round trip per
+    // transaction. Needs a connection of its own for the duration (a RedisClient or a pool
+    // lease, not a RedisMultiplexedConnection).
+    class RedisTransaction {
+    public:
+        using Results = std::vector<RedisResult<RedisValue> >;
+
+        // Called after WATCH and the reads; fills the transaction from the read replies. An error
+        // aborts without EXEC; an empty transaction ends with UNWATCH and no results.
+        using Builder = std::function<RedisResult<void>(std::span<const RedisResult<RedisValue> > reads,
+                                                        RedisTransaction &tx)>;
+
+        RedisTransaction &add(std::string_view cmd, std::span<const std::string_view> args);
+
+        template<typename... Args>
+        RedisTransaction &add(std::string_view cmd, Args &&... args) {
+            std::array<std::string_view, sizeof...(Args)> arr{std::string_view{std::forward<Args>(args)}...};
+            return add(cmd, std::span<const std::string_view>(arr.data(), arr.size()));
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return cmds_.size(); }
+        [[nodiscard]] bool empty() const noexcept { return cmds_.empty(); }
+
+        void clear() noexcept;
+
+        // One result per queued command; nullopt when EXEC was aborted by a WATCHed key.
+        task::Awaitable<RedisResult<std::optional<Results> > > exec(RedisClient &client) const;
+
+        // Optimistic locking: WATCH `keys` pipelined with `reads`, build(), then MULTI..EXEC; an
+        // aborted EXEC starts over after a capped exponential backoff. Two round trips per attempt.
+        static task::Awaitable<RedisResult<Results> > watch(
+            RedisClient &client,
+            std::span<const std::string_view> keys,
+            std::span<const RedisCommandView> reads,
+            Builder build,
+            RedisWatchOptions opts = {});
+
+    private:
+        struct Cmd {
+            std::size_t name_off{0};
+            std::size_t name_len{0};
+            std::size_t first_arg{0};
+            std::size_t arg_count{0};
+        };
+
+        // command names and arguments, copied back to back
+        std::string buf_;
+        std::vector<std::pair<std::size_t, std::size_t> > args_;
+        std::vector<Cmd> cmds_;
+
+        std::size_t append(std::string_view s);
+    };
+} // namespace usub::uredis
+
+#endif // UREDIS_REDISTRANSACTION_H
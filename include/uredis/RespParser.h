@@ -23,6 +23,22 @@ namespace usub::uredis
 
         std::optional<RedisValue> next();
 
+        struct PushMessage
+        {
+            enum class Kind { Other, Incomplete, Message, PMessage, SMessage };
+
+            Kind kind{Kind::Other};
+            std::string_view pattern; // PMessage only
+            std::string_view channel;
+            std::string_view payload;
+        };
+
+        // Pub/sub fast path: recognizes a message/pmessage/smessage push at the current position
+        // without building a RedisValue. The views point into the parser buffer and stay valid
+        // until the next feed()/next()/next_push(). Other: the next value is something else
+        // (nothing consumed, use next()); Incomplete: more input is needed.
+        PushMessage next_push();
+
     private:
         std::vector<uint8_t> buffer_;
         std::size_t pos_{0};
@@ -0,0 +1,313 @@
+#include "uredis/RedisBlockingPool.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    namespace
+    {
+        RedisError cancelled_error()
+        {
+            return RedisError{RedisErrorCategory::Io, "RedisBlockingPool: cancelled"};
+        }
+    }
+
+    RedisBlockingPool::RedisBlockingPool(RedisBlockingPoolConfig cfg)
+        : cfg_(std::move(cfg))
+          , slots_(static_cast<int>(std::max<std::size_t>(1, cfg_.max_connections)))
+          , control_(cfg_.redis, 64)
+    {
+    }
+
+    std::string RedisBlockingPool::seconds(std::chrono::milliseconds block)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(block.count()) / 1000.0);
+        return buf;
+    }
+
+    task::Awaitable<RedisResult<RedisBlockingPool::Conn>> RedisBlockingPool::acquire()
+    {
+        co_await this->slots_.acquire();
+
+        {
+            auto g = co_await this->idle_mutex_.lock();
+            while (!this->idle_.empty())
+            {
+                Conn conn = std::move(this->idle_.back());
+                this->idle_.pop_back();
+                if (conn.client->connected())
+                {
+                    co_return conn;
+                }
+                this->open_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        auto client = std::make_shared<RedisClient>(this->cfg_.redis);
+        auto c = co_await client->connect();
+        if (!c)
+        {
+#ifdef UREDIS_LOGS
+            ulog::error("RedisBlockingPool::acquire: connect failed: {}", c.error().message);
+#endif
+            this->slots_.release();
+            co_return std::unexpected(c.error());
+        }
+
+        // needed by CLIENT UNBLOCK
+        auto id = co_await client->command("CLIENT", "ID");
+        if (!id || !id->is_integer())
+        {
+            this->slots_.release();
+            if (!id) co_return std::unexpected(id.error());
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "CLIENT ID: unexpected type"});
+        }
+
+        this->open_.fetch_add(1, std::memory_order_relaxed);
+        co_return Conn{std::move(client), id->as_integer()};
+    }
+
+    task::Awaitable<void> RedisBlockingPool::release(Conn conn, bool reusable)
+    {
+        if (reusable)
+        {
+            auto g = co_await this->idle_mutex_.lock();
+            if (this->idle_.size() < this->cfg_.max_idle)
+            {
+                this->idle_.push_back(std::move(conn));
+                conn.client.reset();
+            }
+        }
+
+        // not kept: the socket closes with the last reference
+        if (conn.client)
+            this->open_.fetch_sub(1, std::memory_order_relaxed);
+
+        this->slots_.release();
+    }
+
+    task::Awaitable<RedisResult<RedisValue>> RedisBlockingPool::command(
+        std::string_view cmd,
+        std::span<const std::string_view> args,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        if (block.count() <= 0)
+        {
+            co_return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol, "RedisBlockingPool: block time must be positive"
+            });
+        }
+        if (cancel && cancel->cancelled.load())
+        {
+            co_return std::unexpected(cancelled_error());
+        }
+
+        auto conn = co_await this->acquire();
+        if (!conn)
+        {
+            co_return std::unexpected(conn.error());
+        }
+
+        if (cancel)
+        {
+            cancel->client_id.store(conn->id);
+            if (cancel->cancelled.load())
+            {
+                cancel->client_id.store(-1);
+                co_await this->release(std::move(*conn), true);
+                co_return std::unexpected(cancelled_error());
+            }
+        }
+
+        // pipeline() sends once; command() would resend after an I/O error and could pop twice
+        const RedisCommandView one{cmd, args};
+        auto r = co_await conn->client->pipeline(std::span<const RedisCommandView>(&one, 1),
+                                                 static_cast<int>(block.count()) + this->cfg_.timeout_margin_ms);
+
+        bool cancelled = false;
+        if (cancel)
+        {
+            cancel->client_id.store(-1);
+            cancelled = cancel->cancelled.load();
+        }
+
+        // a CLIENT UNBLOCK may still be on its way to this connection, keep it away from other calls
+        co_await this->release(std::move(*conn), r.has_value() && !cancelled);
+
+        if (!r)
+        {
+#ifdef UREDIS_LOGS
+            ulog::warn("RedisBlockingPool::command: {} failed: {}", cmd, r.error().message);
+#endif
+            co_return std::unexpected(r.error());
+        }
+
+        auto& reply = r->front();
+        if (!reply)
+        {
+            co_return std::unexpected(reply.error());
+        }
+        if (cancelled && reply->is_null())
+        {
+            co_return std::unexpected(cancelled_error());
+        }
+
+        co_return std::move(*reply);
+    }
+
+    task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> RedisBlockingPool::pop(
+        std::string_view cmd,
+        std::span<const std::string_view> keys,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        using Popped = std::optional<std::pair<std::string, std::string>>;
+
+        const auto timeout = seconds(block);
+        std::vector<std::string_view> args(keys.begin(), keys.end());
+        args.push_back(timeout);
+
+        auto r = co_await this->command(cmd, args, block, std::move(cancel));
+        if (!r) co_return std::unexpected(r.error());
+
+        if (r->is_null()) co_return Popped{};
+
+        if (!r->is_array() || r->as_array().size() != 2)
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, std::string(cmd) + ": unexpected type"});
+        }
+
+        const auto& arr = r->as_array();
+        co_return Popped{std::in_place, arr[0].as_string(), arr[1].as_string()};
+    }
+
+    task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> RedisBlockingPool::blpop(
+        std::span<const std::string_view> keys,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        co_return co_await this->pop("BLPOP", keys, block, std::move(cancel));
+    }
+
+    task::Awaitable<RedisResult<std::optional<std::pair<std::string, std::string>>>> RedisBlockingPool::brpop(
+        std::span<const std::string_view> keys,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        co_return co_await this->pop("BRPOP", keys, block, std::move(cancel));
+    }
+
+    task::Awaitable<RedisResult<std::optional<std::string>>> RedisBlockingPool::blmove(
+        std::string_view source,
+        std::string_view destination,
+        std::string_view where_from,
+        std::string_view where_to,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        const auto timeout = seconds(block);
+        const std::string_view args[5] = {source, destination, where_from, where_to, timeout};
+
+        auto r = co_await this->command("BLMOVE", args, block, std::move(cancel));
+        if (!r) co_return std::unexpected(r.error());
+
+        if (r->is_null()) co_return std::optional<std::string>{};
+        if (!r->is_bulk_string())
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "BLMOVE: unexpected type"});
+        }
+        co_return std::optional<std::string>{r->as_string()};
+    }
+
+    task::Awaitable<RedisResult<RedisValue>> RedisBlockingPool::xread(
+        std::span<const std::string_view> keys,
+        std::span<const std::string_view> ids,
+        std::size_t count,
+        std::chrono::milliseconds block,
+        std::shared_ptr<CancelToken> cancel)
+    {
+        if (keys.size() != ids.size())
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "XREAD: keys and ids differ in size"});
+        }
+
+        const auto count_s = std::to_string(std::max<std::size_t>(1, count));
+        const auto block_s = std::to_string(block.count());
+
+        std::vector<std::string_view> args;
+        args.reserve(5 + keys.size() * 2);
+        args.insert(args.end(), {"COUNT", count_s, "BLOCK", block_s, "STREAMS"});
+        args.insert(args.end(), keys.begin(), keys.end());
+        args.insert(args.end(), ids.begin(), ids.end());
+
+        co_return co_await this->command("XREAD", args, block, std::move(cancel));
+    }
+
+    task::Awaitable<RedisResult<int64_t>> RedisBlockingPool::wait(
+        RedisClient& client,
+        int64_t num_replicas,
+        std::chrono::milliseconds block)
+    {
+        if (block.count() <= 0)
+        {
+            co_return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol, "RedisBlockingPool: block time must be positive"
+            });
+        }
+
+        const auto replicas = std::to_string(num_replicas);
+        const auto block_s = std::to_string(block.count());
+        const std::string_view args[2] = {replicas, block_s};
+
+        // sent once: on a reconnected socket WAIT would count nothing. The longer timeout is
+        // passed per call, the client's own io_timeout_ms stays as it is for its other callers.
+        const RedisCommandView one{"WAIT", args};
+        auto r = co_await client.pipeline(std::span<const RedisCommandView>(&one, 1),
+                                          static_cast<int>(block.count()) + this->cfg_.timeout_margin_ms);
+
+        if (!r) co_return std::unexpected(r.error());
+        auto& reply = r->front();
+        if (!reply) co_return std::unexpected(reply.error());
+
+        if (!reply->is_integer())
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "WAIT: unexpected type"});
+        }
+        co_return reply->as_integer();
+    }
+
+    task::Awaitable<void> RedisBlockingPool::cancel(std::shared_ptr<CancelToken> token)
+    {
+        if (!token) co_return;
+
+        token->cancelled.store(true);
+
+        // The call may not have reached the server yet, in which case UNBLOCK finds nothing
+        // blocked: retry until it hits or the call is over.
+        for (;;)
+        {
+            const auto id = token->client_id.load();
+            if (id < 0) co_return;
+
+            const auto id_s = std::to_string(id);
+            auto r = co_await this->control_.command("CLIENT", "UNBLOCK", id_s);
+            if (!r)
+            {
+#ifdef UREDIS_LOGS
+                ulog::warn("RedisBlockingPool::cancel: CLIENT UNBLOCK {} failed: {}", id, r.error().message);
+#endif
+                co_return;
+            }
+            if (r->is_integer() && r->as_integer() == 1) co_return;
+
+            co_await system::this_coroutine::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+} // namespace usub::uredis
@@ -1,4 +1,10 @@
 #include "uredis/RedisBus.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+
 #ifdef UREDIS_LOGS
 #include <ulog/ulog.h>
 #endif
@@ -8,6 +14,113 @@ namespace usub::uredis
     RedisBus::RedisBus(Config cfg)
         : cfg_(std::move(cfg))
     {
+        if (this->cfg_.loopback)
+        {
+            std::random_device rd;
+            const std::uint64_t id = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(id));
+            this->origin_ = hex;
+        }
+        this->local_.store(std::make_shared<const LocalHandlers>());
+
+        const std::size_t n = std::max<std::size_t>(1, this->cfg_.publish_connections);
+        this->publishers_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            this->publishers_.push_back(std::make_shared<RedisMultiplexedConnection>(
+                this->cfg_.redis, this->cfg_.max_inflight_per_publisher));
+        }
+    }
+
+    void RedisBus::refresh_local_locked()
+    {
+        if (!this->cfg_.loopback) return;
+
+        auto next = std::make_shared<LocalHandlers>();
+        next->channels.insert(this->desired_channels_.begin(), this->desired_channels_.end());
+        next->pattern_handlers.reserve(this->desired_patterns_.size());
+        for (const auto& [pattern, h] : this->desired_patterns_)
+        {
+            next->patterns.insert(pattern, next->pattern_handlers.size());
+            next->pattern_handlers.push_back(h);
+        }
+        this->local_.store(std::move(next), std::memory_order_release);
+    }
+
+    void RedisBus::deliver_local(std::string_view channel, std::string_view payload) const
+    {
+        auto local = this->local_.load(std::memory_order_acquire);
+
+        auto it = local->channels.find(channel);
+        if (it != local->channels.end())
+            it->second(channel, payload);
+
+        if (local->patterns.empty()) return;
+
+        // one delivery per handler even if several trie paths match; the seen list stays on the
+        // stack unless more than its capacity of patterns match one channel
+        std::array<std::size_t, 16> seen;
+        std::size_t n_seen = 0;
+        std::vector<std::size_t> seen_more;
+        local->patterns.match(channel, [&](std::size_t v)
+        {
+            if (std::find(seen.begin(), seen.begin() + n_seen, v) != seen.begin() + n_seen) return;
+            if (std::find(seen_more.begin(), seen_more.end(), v) != seen_more.end()) return;
+            if (n_seen < seen.size())
+                seen[n_seen++] = v;
+            else
+                seen_more.push_back(v);
+            local->pattern_handlers[v](channel, payload);
+        });
+    }
+
+    std::string RedisBus::tag_payload(std::string_view payload) const
+    {
+        std::string out;
+        out.reserve(origin_tag_size + payload.size());
+        out.append("\x1eUB");
+        out.append(this->origin_);
+        out.push_back('\x1e');
+        out.append(payload);
+        return out;
+    }
+
+    RedisBus::ViewCallback RedisBus::wrap(Handler h) const
+    {
+        if (!this->cfg_.loopback)
+        {
+            if (h.view) return std::move(h.view);
+            return [h = std::move(h)](std::string_view channel, std::string_view payload) { h(channel, payload); };
+        }
+
+        return [origin = this->origin_, h = std::move(h)](std::string_view channel, std::string_view payload)
+        {
+            const bool tagged = payload.size() >= origin_tag_size
+                                && payload.starts_with("\x1eUB")
+                                && payload[origin_tag_size - 1] == '\x1e';
+            if (!tagged)
+            {
+                h(channel, payload);
+                return;
+            }
+
+            // our own publish, already delivered by deliver_local()
+            if (payload.substr(3, origin.size()) == origin) return;
+
+            h(channel, payload.substr(origin_tag_size));
+        };
+    }
+
+    std::shared_ptr<RedisMultiplexedConnection> RedisBus::pick_publisher() const
+    {
+        auto best = this->publishers_.front();
+        for (const auto& p : this->publishers_)
+        {
+            if (p->inflight() < best->inflight())
+                best = p;
+        }
+        return best;
     }
 
     void RedisBus::notify_error(const RedisError& err) const
@@ -24,28 +137,16 @@ namespace usub::uredis
 
     task::Awaitable<RedisResult<void>> RedisBus::ensure_connected_locked()
     {
-        if (this->connected_ && this->pub_client_ && this->sub_client_)
+        if (this->connected_ && this->sub_client_)
         {
             co_return RedisResult<void>{};
         }
 
-        this->pub_client_.reset();
+        // publishing needs no setup here: the multiplexed publishers connect on demand
         this->sub_client_.reset();
         this->connected_ = false;
 
-        this->pub_client_ = std::make_shared<RedisClient>(this->cfg_.redis);
-        this->sub_client_ = std::make_shared<RedisSubscriber>(this->cfg_.redis);
-
-        auto cp = co_await this->pub_client_->connect();
-        if (!cp)
-        {
-            const auto& err = cp.error();
-#ifdef UREDIS_LOGS
-            usub::ulog::error("RedisBus::ensure_connected_locked: pub connect failed: {}", err.message);
-#endif
-            this->notify_error(err);
-            co_return std::unexpected(err);
-        }
+        this->sub_client_ = std::make_shared<RedisSubscriber>(this->cfg_.redis, this->cfg_.dispatch);
 
         auto cs = co_await this->sub_client_->connect();
         if (!cs)
@@ -60,7 +161,7 @@ namespace usub::uredis
 
         this->connected_ = true;
 #ifdef UREDIS_LOGS
-        usub::ulog::info("RedisBus: connected pub+sub");
+        usub::ulog::info("RedisBus: connected sub");
 #endif
 
         auto r = co_await this->resubscribe_all_locked();
@@ -85,27 +186,39 @@ namespace usub::uredis
             co_return std::unexpected(err);
         }
 
-        for (auto& [ch, cb] : this->desired_channels_)
+        std::vector<RedisSubscriber::Subscription> channels;
+        channels.reserve(this->desired_channels_.size());
+        for (auto& [ch, h] : this->desired_channels_)
+            channels.push_back(RedisSubscriber::Subscription{.name = ch, .view_callback = this->wrap(h)});
+
+        std::vector<RedisSubscriber::Subscription> patterns;
+        patterns.reserve(this->desired_patterns_.size());
+        for (auto& [pat, h] : this->desired_patterns_)
+            patterns.push_back(RedisSubscriber::Subscription{.name = pat, .view_callback = this->wrap(h)});
+
+        if (!channels.empty())
         {
-            auto r = co_await this->sub_client_->subscribe(ch, cb);
+            auto r = co_await this->sub_client_->subscribe(channels);
             if (!r)
             {
                 const auto& err = r.error();
 #ifdef UREDIS_LOGS
-                usub::ulog::info("RedisBus::resubscribe_all_locked: SUBSCRIBE {} failed: {}", ch, err.message);
+                usub::ulog::info("RedisBus::resubscribe_all_locked: SUBSCRIBE ({} channels) failed: {}",
+                                 channels.size(), err.message);
 #endif
                 this->notify_error(err);
             }
         }
 
-        for (auto& [pat, cb] : this->desired_patterns_)
+        if (!patterns.empty())
         {
-            auto r = co_await this->sub_client_->psubscribe(pat, cb);
+            auto r = co_await this->sub_client_->psubscribe(patterns);
             if (!r)
             {
                 const auto& err = r.error();
 #ifdef UREDIS_LOGS
-                usub::ulog::info("RedisBus::resubscribe_all_locked: PSUBSCRIBE {} failed: {}", pat, err.message);
+                usub::ulog::info("RedisBus::resubscribe_all_locked: PSUBSCRIBE ({} patterns) failed: {}",
+                                 patterns.size(), err.message);
 #endif
                 this->notify_error(err);
             }
@@ -116,9 +229,10 @@ namespace usub::uredis
 
     RedisResult<void> RedisBus::apply_subscribe_locked(
         const std::string& channel,
-        const Callback& cb)
+        const Handler& h)
     {
-        this->desired_channels_[channel] = cb;
+        this->desired_channels_[channel] = h;
+        this->refresh_local_locked();
         if (!this->connected_ || !this->sub_client_)
         {
             return RedisResult<void>{};
@@ -128,9 +242,10 @@ namespace usub::uredis
 
     RedisResult<void> RedisBus::apply_psubscribe_locked(
         const std::string& pattern,
-        const Callback& cb)
+        const Handler& h)
     {
-        this->desired_patterns_[pattern] = cb;
+        this->desired_patterns_[pattern] = h;
+        this->refresh_local_locked();
         if (!this->connected_ || !this->sub_client_)
         {
             return RedisResult<void>{};
@@ -141,46 +256,173 @@ namespace usub::uredis
     RedisResult<void> RedisBus::apply_unsubscribe_locked(const std::string& channel)
     {
         this->desired_channels_.erase(channel);
+        this->refresh_local_locked();
         return RedisResult<void>{};
     }
 
     RedisResult<void> RedisBus::apply_punsubscribe_locked(const std::string& pattern)
     {
         this->desired_patterns_.erase(pattern);
+        this->refresh_local_locked();
         return RedisResult<void>{};
     }
 
     task::Awaitable<RedisResult<void>> RedisBus::publish(
         std::string_view channel,
         std::string_view payload)
+    {
+        if (this->stopping_.load(std::memory_order_acquire))
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisBus: closed"});
+        }
+
+        if (this->cfg_.loopback)
+        {
+            this->deliver_local(channel, payload);
+            const auto tagged = this->tag_payload(payload);
+            auto resp = co_await this->pick_publisher()->command("PUBLISH", channel, tagged);
+            if (!resp)
+            {
+                this->notify_error(resp.error());
+                co_return std::unexpected(resp.error());
+            }
+            co_return RedisResult<void>{};
+        }
+
+        // the multiplexed connection (re)connects on demand
+        auto resp = co_await this->pick_publisher()->command("PUBLISH", channel, payload);
+        if (!resp)
+        {
+            auto err = resp.error();
+#ifdef UREDIS_LOGS
+            usub::ulog::error("RedisBus::publish: PUBLISH {} failed: {}", channel, err.message);
+#endif
+            this->notify_error(err);
+            co_return std::unexpected(err);
+        }
+
+        co_return RedisResult<void>{};
+    }
+
+    void RedisBus::publish_detached(std::string channel, std::string payload)
+    {
+        if (this->stopping_.load(std::memory_order_acquire))
+        {
+            this->notify_error(RedisError{RedisErrorCategory::Io, "RedisBus: closed"});
+            return;
+        }
+
+        if (this->cfg_.loopback)
+        {
+            this->deliver_local(channel, payload);
+            payload = this->tag_payload(payload);
+        }
+
+        system::co_spawn(publish_task(this->pick_publisher(), std::move(channel), std::move(payload),
+                                      this->cfg_.on_error));
+    }
+
+    task::Awaitable<void> RedisBus::publish_task(
+        std::shared_ptr<RedisMultiplexedConnection> pub,
+        std::string channel,
+        std::string payload,
+        std::function<void(const RedisError&)> on_error)
+    {
+        // owns everything it touches, so the bus may be gone by the time the reply arrives
+        auto resp = co_await pub->command("PUBLISH", channel, payload);
+        if (!resp && on_error)
+            on_error(resp.error());
+    }
+
+    task::Awaitable<RedisResult<void>> RedisBus::subscribe(
+        std::string channel,
+        Callback cb)
+    {
+        co_return co_await this->subscribe_handler(std::move(channel), Handler{.owned = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisBus::subscribe_view(
+        std::string channel,
+        ViewCallback cb)
+    {
+        co_return co_await this->subscribe_handler(std::move(channel), Handler{.view = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisBus::subscribe_handler(
+        std::string channel,
+        Handler h)
     {
         auto guard = co_await this->mutex_.lock();
 
+        this->desired_channels_[channel] = h;
+        this->refresh_local_locked();
+
         auto ec = co_await this->ensure_connected_locked();
         if (!ec)
             co_return std::unexpected(ec.error());
 
-        if (!this->pub_client_)
+        if (!this->sub_client_)
+        {
+            RedisError err{RedisErrorCategory::Io, "RedisBus: sub_client is null"};
+            this->notify_error(err);
+            co_return std::unexpected(err);
+        }
+
+        auto r = co_await this->sub_client_->subscribe_view(channel, this->wrap(std::move(h)));
+        if (!r)
         {
-            RedisError err{RedisErrorCategory::Io, "RedisBus: pub_client is null"};
+            auto err = r.error();
+#ifdef UREDIS_LOGS
+            usub::ulog::error("RedisBus::subscribe: SUBSCRIBE {} failed: {}", channel, err.message);
+#endif
             this->notify_error(err);
             co_return std::unexpected(err);
         }
 
-        std::string ch{channel};
-        std::string pl{payload};
+        co_return RedisResult<void>{};
+    }
 
-        std::string_view args_arr[2] = {ch, pl};
-        auto resp = co_await this->pub_client_->command(
-            "PUBLISH",
-            std::span<const std::string_view>(args_arr, 2));
-        if (!resp)
+    task::Awaitable<RedisResult<void>> RedisBus::psubscribe(
+        std::string pattern,
+        Callback cb)
+    {
+        co_return co_await this->psubscribe_handler(std::move(pattern), Handler{.owned = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisBus::psubscribe_view(
+        std::string pattern,
+        ViewCallback cb)
+    {
+        co_return co_await this->psubscribe_handler(std::move(pattern), Handler{.view = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisBus::psubscribe_handler(
+        std::string pattern,
+        Handler h)
+    {
+        auto guard = co_await this->mutex_.lock();
+
+        this->desired_patterns_[pattern] = h;
+        this->refresh_local_locked();
+
+        auto ec = co_await this->ensure_connected_locked();
+        if (!ec)
+            co_return std::unexpected(ec.error());
+
+        if (!this->sub_client_)
         {
-            auto err = resp.error();
+            RedisError err{RedisErrorCategory::Io, "RedisBus: sub_client is null"};
+            this->notify_error(err);
+            co_return std::unexpected(err);
+        }
+
+        auto r = co_await this->sub_client_->psubscribe_view(pattern, this->wrap(std::move(h)));
+        if (!r)
+        {
+            auto err = r.error();
 #ifdef UREDIS_LOGS
-            usub::ulog::error("RedisBus::publish: PUBLISH {} failed: {}", ch, err.message);
+            usub::ulog::error("RedisBus::psubscribe: PSUBSCRIBE {} failed: {}", pattern, err.message);
 #endif
-            this->connected_ = false;
             this->notify_error(err);
             co_return std::unexpected(err);
         }
@@ -189,12 +431,15 @@ namespace usub::uredis
     }
 
     task::Awaitable<RedisResult<void>> RedisBus::subscribe(
-        std::string channel,
+        std::span<const std::string> channels,
         Callback cb)
     {
         auto guard = co_await this->mutex_.lock();
 
-        this->desired_channels_[channel] = cb;
+        const Handler h{.owned = std::move(cb)};
+        for (const auto& ch : channels)
+            this->desired_channels_[ch] = h;
+        this->refresh_local_locked();
 
         auto ec = co_await this->ensure_connected_locked();
         if (!ec)
@@ -207,12 +452,18 @@ namespace usub::uredis
             co_return std::unexpected(err);
         }
 
-        auto r = co_await this->sub_client_->subscribe(channel, cb);
+        std::vector<RedisSubscriber::Subscription> subs;
+        subs.reserve(channels.size());
+        const auto view = this->wrap(h);
+        for (const auto& ch : channels)
+            subs.push_back(RedisSubscriber::Subscription{.name = ch, .view_callback = view});
+
+        auto r = co_await this->sub_client_->subscribe(subs);
         if (!r)
         {
             auto err = r.error();
 #ifdef UREDIS_LOGS
-            usub::ulog::error("RedisBus::subscribe: SUBSCRIBE {} failed: {}", channel, err.message);
+            usub::ulog::error("RedisBus::subscribe: SUBSCRIBE ({} channels) failed: {}", channels.size(), err.message);
 #endif
             this->notify_error(err);
             co_return std::unexpected(err);
@@ -222,12 +473,15 @@ namespace usub::uredis
     }
 
     task::Awaitable<RedisResult<void>> RedisBus::psubscribe(
-        std::string pattern,
+        std::span<const std::string> patterns,
         Callback cb)
     {
         auto guard = co_await this->mutex_.lock();
 
-        this->desired_patterns_[pattern] = cb;
+        const Handler h{.owned = std::move(cb)};
+        for (const auto& pat : patterns)
+            this->desired_patterns_[pat] = h;
+        this->refresh_local_locked();
 
         auto ec = co_await this->ensure_connected_locked();
         if (!ec)
@@ -240,12 +494,18 @@ namespace usub::uredis
             co_return std::unexpected(err);
         }
 
-        auto r = co_await this->sub_client_->psubscribe(pattern, cb);
+        std::vector<RedisSubscriber::Subscription> subs;
+        subs.reserve(patterns.size());
+        const auto view = this->wrap(h);
+        for (const auto& pat : patterns)
+            subs.push_back(RedisSubscriber::Subscription{.name = pat, .view_callback = view});
+
+        auto r = co_await this->sub_client_->psubscribe(subs);
         if (!r)
         {
             auto err = r.error();
 #ifdef UREDIS_LOGS
-            usub::ulog::error("RedisBus::psubscribe: PSUBSCRIBE {} failed: {}", pattern, err.message);
+            usub::ulog::error("RedisBus::psubscribe: PSUBSCRIBE ({} patterns) failed: {}", patterns.size(), err.message);
 #endif
             this->notify_error(err);
             co_return std::unexpected(err);
@@ -259,6 +519,7 @@ namespace usub::uredis
         auto guard = co_await this->mutex_.lock();
 
         this->desired_channels_.erase(channel);
+        this->refresh_local_locked();
 
         if (!this->connected_ || !this->sub_client_)
         {
@@ -284,6 +545,7 @@ namespace usub::uredis
         auto guard = co_await this->mutex_.lock();
 
         this->desired_patterns_.erase(pattern);
+        this->refresh_local_locked();
 
         if (!this->connected_ || !this->sub_client_)
         {
@@ -343,7 +605,6 @@ namespace usub::uredis
                     co_return;
 
                 if (!this->connected_
-                    || !this->pub_client_
                     || !this->sub_client_
                     || !this->sub_client_->is_connected())
                 {
@@ -356,10 +617,10 @@ namespace usub::uredis
                     continue;
                 }
 
-                std::string_view args_arr[0]{};
-                auto resp = co_await this->pub_client_->command(
+                // over a publisher: keeps the publish path warm and checks it
+                auto resp = co_await this->pick_publisher()->command(
                     "PING",
-                    std::span<const std::string_view>(args_arr, 0));
+                    std::span<const std::string_view>{});
                 if (!resp)
                 {
                     auto err = resp.error();
@@ -391,11 +652,8 @@ namespace usub::uredis
             this->sub_client_.reset();
         }
 
-        if (this->pub_client_)
-        {
-            this->pub_client_->command("QUIT", std::span<const std::string_view>{});
-            this->pub_client_.reset();
-        }
+        for (auto& p : this->publishers_)
+            p->close();
 
         co_return;
     }
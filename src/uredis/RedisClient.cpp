@@ -5,6 +5,11 @@
 #include <string>
 #include <array>
 #include <cctype>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #ifdef UREDIS_LOGS
 #include <ulog/ulog.h>
@@ -36,8 +41,8 @@ namespace usub::uredis {
         normalize_auth(config_.password);
 
 #ifdef UREDIS_LOGS
-        ulog::debug("RedisClient::ctor: this={} host=\"{}\" port={} db={} user_set={} pass_set={}",
-                    ptr_id(this), config_.host, config_.port, config_.db,
+        ulog::debug("RedisClient::ctor: this={} endpoint=\"{}\" db={} user_set={} pass_set={}",
+                    ptr_id(this), endpoint(config_), config_.db,
                     config_.username.has_value(), config_.password.has_value());
 
         if (config_.password) {
@@ -77,6 +82,54 @@ namespace usub::uredis {
         socket_.reset();
     }
 
+    std::string RedisClient::endpoint(const RedisConfig &cfg) {
+        if (!cfg.unix_path.empty())
+            return "unix:" + cfg.unix_path;
+        return cfg.host + ":" + std::to_string(cfg.port);
+    }
+
+    task::Awaitable<RedisResult<std::shared_ptr<net::TCPClientSocket> > > RedisClient::open_socket(
+        const RedisConfig &cfg) {
+        if (cfg.unix_path.empty()) {
+            auto sock = std::make_shared<net::TCPClientSocket>();
+            const std::string port_str = std::to_string(cfg.port);
+            auto rc = co_await sock->async_connect(cfg.host.c_str(), port_str.c_str());
+            if (rc.has_value()) {
+                sock->shutdown();
+                co_return std::unexpected(RedisError{RedisErrorCategory::Io, "async_connect failed"});
+            }
+            co_return sock;
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (cfg.unix_path.size() >= sizeof(addr.sun_path)) {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "unix_path too long"});
+        }
+        std::memcpy(addr.sun_path, cfg.unix_path.data(), cfg.unix_path.size());
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            co_return std::unexpected(RedisError{
+                RedisErrorCategory::Io, std::string("socket(AF_UNIX) failed: ") + std::strerror(errno)
+            });
+        }
+
+        // A local connect completes or fails right away; EAGAIN means the server's backlog is
+        // full, which the caller's reconnect handles like any other failed connect.
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+            const int err = errno;
+            ::close(fd);
+            co_return std::unexpected(RedisError{
+                RedisErrorCategory::Io, "connect " + endpoint(cfg) + " failed: " + std::strerror(err)
+            });
+        }
+
+        // the uvent socket only does non-blocking stream reads/writes on the fd, so it is
+        // protocol-agnostic once connected
+        co_return std::make_shared<net::TCPClientSocket>(fd);
+    }
+
     task::Awaitable<RedisResult<void> > RedisClient::connect() {
         co_return co_await connect_unlocked();
     }
@@ -93,36 +146,34 @@ namespace usub::uredis {
             connected_ = false;
             parser_.reset();
             socket_.reset();
-            socket_ = std::make_shared<net::TCPClientSocket>();
-
-            const std::string port_str = std::to_string(config_.port);
 
 #ifdef UREDIS_LOGS
             ulog::info(
-                "RedisClient::connect: attempt={} this={} host=\"{}\" port={} db={} socket={} user_set={} pass_set={}",
-                attempt, ptr_id(this), config_.host, config_.port, config_.db, ptr_id(socket_.get()),
+                "RedisClient::connect: attempt={} this={} endpoint=\"{}\" db={} user_set={} pass_set={}",
+                attempt, ptr_id(this), endpoint(config_), config_.db,
                 config_.username.has_value(), config_.password.has_value());
 #endif
 
-            auto rc = co_await socket_->async_connect(config_.host.c_str(), port_str.c_str());
-            if (rc.has_value()) {
+            auto sock = co_await open_socket(config_);
+            if (!sock) {
 #ifdef UREDIS_LOGS
-                ulog::error("RedisClient::connect: async_connect failed this={} host=\"{}\" port={} attempt={}",
-                            ptr_id(this), config_.host, config_.port, attempt);
+                ulog::error("RedisClient::connect: {} this={} endpoint=\"{}\" attempt={}",
+                            sock.error().message, ptr_id(this), endpoint(config_), attempt);
 #endif
                 hard_close_socket_unlocked();
                 if (attempt == 0) continue;
-                co_return std::unexpected(RedisError{RedisErrorCategory::Io, "async_connect failed"});
+                co_return std::unexpected(sock.error());
             }
 
+            socket_ = std::move(*sock);
             connected_ = true;
 
             auto auth = co_await auth_and_select_unlocked();
             if (!auth) {
 #ifdef UREDIS_LOGS
                 ulog::error(
-                    R"(RedisClient::connect: AUTH/SELECT failed this={} host="{}" port={} category={} msg="{}")",
-                    ptr_id(this), config_.host, config_.port,
+                    R"(RedisClient::connect: AUTH/SELECT failed this={} endpoint="{}" category={} msg="{}")",
+                    ptr_id(this), endpoint(config_),
                     (int) auth.error().category, auth.error().message);
 #endif
                 hard_close_socket_unlocked();
@@ -168,6 +219,11 @@ namespace usub::uredis {
             if (!r) co_return std::unexpected(r.error());
         }
 
+        if (config_.readonly) {
+            auto r = co_await send_and_read_unlocked("READONLY", std::span<const std::string_view>{});
+            if (!r) co_return std::unexpected(r.error());
+        }
+
         co_return RedisResult<void>{};
     }
 
@@ -200,7 +256,7 @@ namespace usub::uredis {
         return out;
     }
 
-    task::Awaitable<RedisResult<RedisValue> > RedisClient::read_one_reply_unlocked() {
+    task::Awaitable<RedisResult<RedisValue> > RedisClient::read_one_reply_unlocked(int timeout_ms) {
         if (!socket_)
             co_return std::unexpected(RedisError{RedisErrorCategory::Io, "socket is null"});
 
@@ -216,7 +272,7 @@ namespace usub::uredis {
             }
 
             buf.clear();
-            socket_->update_timeout(config_.io_timeout_ms);
+            socket_->update_timeout(timeout_ms);
 
             constexpr std::size_t max_read = 64 * 1024;
             const ssize_t rdsz = co_await socket_->async_read(buf, max_read);
@@ -245,14 +301,26 @@ namespace usub::uredis {
 
         std::vector<std::uint8_t> frame = encode_command(cmd, args);
 
+        auto w = co_await write_frame_unlocked(frame, cmd, config_.io_timeout_ms);
+        if (!w) co_return std::unexpected(w.error());
+
+        co_return co_await read_one_reply_unlocked(config_.io_timeout_ms);
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClient::write_frame_unlocked(
+        const std::vector<std::uint8_t> &frame,
+        std::string_view cmd,
+        int timeout_ms) {
         std::size_t off = 0;
         while (off < frame.size()) {
-            socket_->update_timeout(config_.io_timeout_ms);
+            socket_->update_timeout(timeout_ms);
             const ssize_t n = co_await socket_->async_write(frame.data() + off, frame.size() - off);
 
 #ifdef UREDIS_LOGS
             ulog::debug("RedisClient::write: this={} cmd=\"{}\" n={} off={} total={}",
                         ptr_id(this), std::string(cmd), n, off, frame.size());
+#else
+            (void) cmd;
 #endif
 
             if (n <= 0) {
@@ -262,7 +330,44 @@ namespace usub::uredis {
             off += static_cast<std::size_t>(n);
         }
 
-        co_return co_await read_one_reply_unlocked();
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > > RedisClient::pipeline(
+        std::span<const RedisCommandView> cmds) {
+        return pipeline(cmds, config_.io_timeout_ms);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > > RedisClient::pipeline(
+        std::span<const RedisCommandView> cmds,
+        int timeout_ms) {
+        std::vector<RedisResult<RedisValue> > out;
+        if (cmds.empty())
+            co_return out;
+
+        if (!connected_ || closing_ || !socket_) {
+            auto c = co_await connect_unlocked();
+            if (!c) co_return std::unexpected(c.error());
+        }
+
+        std::vector<std::uint8_t> frame;
+        for (const auto &c: cmds) {
+            auto one = encode_command(c.cmd, c.args);
+            frame.insert(frame.end(), one.begin(), one.end());
+        }
+
+        auto w = co_await write_frame_unlocked(frame, cmds.front().cmd, timeout_ms);
+        if (!w) co_return std::unexpected(w.error());
+
+        out.reserve(cmds.size());
+        for (std::size_t i = 0; i < cmds.size(); ++i) {
+            auto r = co_await read_one_reply_unlocked(timeout_ms);
+            if (!r && r.error().category != RedisErrorCategory::ServerReply)
+                co_return std::unexpected(r.error());
+            out.push_back(std::move(r));
+        }
+
+        co_return out;
     }
 
     task::Awaitable<RedisResult<RedisValue> > RedisClient::command(
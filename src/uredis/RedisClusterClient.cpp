@@ -2,14 +2,311 @@
 
 #include <algorithm>
 #include <charconv>
+#include <chrono>
 #include <cctype>
+#include <limits>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #ifdef UREDIS_LOGS
 #include <ulog/ulog.h>
 #endif
 
 namespace usub::uredis {
+    struct RedisClusterClient::Node {
+        RedisConfig cfg;
+
+        usub::queue::concurrent::MPMCQueue<std::shared_ptr<RedisClient>> idle;
+        std::atomic<std::size_t> live_count{0};
+
+        sync::AsyncSemaphore idle_sem{0};
+        std::atomic<std::uint32_t> waiters{0};
+
+        std::atomic<bool> replica{false};
+        std::atomic<std::uint64_t> latency_ewma_us{0};
+        std::atomic<std::uint32_t> inflight{0};
+
+        std::vector<std::shared_ptr<RedisMultiplexedConnection>> mux;
+
+        Node(RedisConfig cfg_, const RedisClusterConfig& ccfg)
+            : cfg(std::move(cfg_))
+            , idle(ccfg.max_connections_per_node) {
+            for (std::size_t i = 0; i < ccfg.multiplexed_connections_per_node; ++i)
+                mux.push_back(std::make_shared<RedisMultiplexedConnection>(
+                    cfg, ccfg.max_inflight_per_connection));
+        }
+
+        void notify_waiters_if_any() noexcept {
+            if (waiters.load(std::memory_order_relaxed) > 0)
+                idle_sem.release();
+        }
+
+        void observe_latency(std::uint64_t us) noexcept;
+
+        [[nodiscard]] std::uint64_t load_score() const noexcept;
+    };
+
+    // Owned by the client and by every background task it spawns, so a topology refresh or a
+    // standby probe in progress keeps the state alive after the client is gone.
+    class RedisClusterClient::Impl : public std::enable_shared_from_this<Impl> {
+        struct FanOut;
+        struct WarmUp;
+
+        friend class RedisClusterClient::ClientLease;
+
+    public:
+        explicit Impl(RedisClusterConfig cfg);
+
+        // Makes background tasks wind down without waiting for them.
+        void shutdown() noexcept;
+
+        task::Awaitable<void> stop();
+
+        task::Awaitable<RedisResult<void>> connect();
+
+        task::Awaitable<RedisResult<void>> refresh_topology();
+
+        void schedule_topology_refresh();
+
+        task::Awaitable<RedisResult<RedisValue>> command(
+            std::string_view cmd,
+            std::span<const std::string_view> args);
+
+        task::Awaitable<RedisResult<ClientLease>>
+        get_client_for_key(std::string_view key);
+
+        task::Awaitable<RedisResult<ClientLease>>
+        get_any_client();
+
+        task::Awaitable<RedisResult<ClientLease>>
+        get_client_for_slot(int slot);
+
+        task::Awaitable<RedisResult<std::vector<RedisNodeGroup>>> group_by_node(
+            std::span<const std::string_view> keys);
+
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> execute_on_node(
+            const RedisClusterNode& node,
+            std::span<const RedisCommandView> cmds);
+
+        task::Awaitable<RedisResult<RedisClusterNode>> master_for_slot(int slot);
+
+        [[nodiscard]] RedisConfig node_config(std::string_view host, std::uint16_t port) const;
+
+        [[nodiscard]] const RedisClusterConfig& config() const noexcept { return cfg_; }
+
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> for_each_node(
+            NodeScope scope,
+            NodeCallback fn,
+            std::size_t max_concurrency = 0);
+
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> for_each_master(
+            NodeCallback fn,
+            std::size_t max_concurrency = 0);
+
+        task::Awaitable<RedisResult<std::vector<RedisNodeReply>>> broadcast(
+            std::string_view cmd,
+            std::span<const std::string_view> args,
+            NodeScope scope = NodeScope::Masters);
+
+        task::Awaitable<RedisResult<int64_t>> dbsize();
+        task::Awaitable<RedisResult<void>> flushall(bool async = false);
+        task::Awaitable<RedisResult<std::vector<std::string>>> keys(std::string_view pattern);
+
+        task::Awaitable<RedisResult<std::string>> script_load(std::string_view script);
+
+        task::Awaitable<RedisResult<std::vector<std::string>>> scan(
+            RedisClusterScanCursor& cursor,
+            const RedisClusterScanOptions& opt = {});
+
+    private:
+        struct PooledClient {
+            std::shared_ptr<Node> node;
+            std::shared_ptr<RedisClient> client;
+            std::shared_ptr<RedisMultiplexedConnection> mux;
+        };
+
+        enum class RedirType { None, Moved, Ask };
+
+        struct Redirection {
+            RedirType type{RedirType::None};
+            int slot{-1};
+            std::string host;
+            std::uint16_t port{0};
+        };
+
+        struct ShardInfo {
+            std::vector<std::pair<int64_t, int64_t>> ranges;
+            std::optional<RedisClusterNode> master;
+            std::vector<RedisClusterNode> replicas;
+        };
+
+        using Topology = std::vector<ShardInfo>;
+
+        // Keys of a migrating slot that answered ASK. Such a key no longer exists on the source
+        // (and a new one would be created on the target), so it is sent to the target directly.
+        // Tracking is per key: keys not yet moved are still served by the source.
+        // transparent hash: migrated keys are looked up by the command's string_view key
+        struct KeyHash {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view s) const noexcept {
+                return std::hash<std::string_view>{}(s);
+            }
+        };
+
+        struct MigratingSlot {
+            std::string host;
+            std::uint16_t port{0};
+            std::unordered_set<std::string, KeyHash, std::equal_to<>> keys;
+        };
+
+        static constexpr std::size_t max_migrating_slots = 256;
+        static constexpr std::size_t max_migrated_keys_per_slot = 4096;
+
+        using IndexedNodeCallback = std::function<
+            task::Awaitable<RedisResult<RedisValue>>(std::size_t, RedisClient&)>;
+
+        RedisClusterConfig cfg_;
+
+        std::vector<std::shared_ptr<Node>> nodes_;
+        std::array<int, 16384> slot_to_node_{};
+        std::vector<std::vector<int>> replicas_of_;
+        std::unordered_map<int, MigratingSlot> migrating_;
+        std::atomic<std::size_t> migrating_count_{0};
+        bool standalone_mode_{false};
+
+        sync::AsyncMutex mutex_;
+
+        sync::AsyncMutex init_mutex_;
+        sync::AsyncEvent init_event_{sync::Reset::Manual, false};
+        bool init_started_{false};
+        bool init_finished_{false};
+        std::optional<RedisResult<void>> init_result_;
+
+        sync::AsyncMutex rediscover_mutex_;
+
+        std::shared_ptr<std::atomic<bool>> alive_{std::make_shared<std::atomic<bool>>(true)};
+
+        // Background tasks hold a ticket while they work and drop it while sleeping, so that
+        // stop() can wait for them to go quiet.
+        struct Background {
+            std::atomic<bool> stopping{false};
+            std::atomic<int> running{0};
+            sync::AsyncEvent idle{sync::Reset::Manual, false};
+
+            bool enter() noexcept {
+                running.fetch_add(1);
+                if (!stopping.load()) return true;
+                leave();
+                return false;
+            }
+
+            void leave() noexcept {
+                if (running.fetch_sub(1) == 1 && stopping.load())
+                    idle.set();
+            }
+        };
+
+        Background bg_;
+        std::atomic<bool> shards_supported_{true};
+        std::atomic<bool> refresh_running_{false};
+        std::atomic<bool> refresh_pending_{false};
+        std::atomic<std::int64_t> last_refresh_ms_{0};
+        std::atomic<int> moved_since_refresh_{0};
+
+        static std::optional<Redirection> parse_redirection(const std::string& msg);
+        static bool is_slot_mapping_empty_error(const RedisError& e) noexcept;
+        static bool is_readonly_command(std::string_view cmd) noexcept;
+
+        RedisResult<int> node_index_for_slot_locked(int slot) const;
+        RedisResult<int> node_index_for_key_locked(std::string_view key) const;
+
+        int ensure_node_locked(std::string_view host, std::uint16_t port, bool replica = false);
+        int pick_read_node_locked(int master_idx) const;
+
+        void setup_standalone_locked();
+        bool has_full_slot_mapping_locked() const noexcept;
+
+        task::Awaitable<RedisResult<std::shared_ptr<RedisClient>>>
+        connect_to_node(std::string_view host, std::uint16_t port);
+
+        static task::Awaitable<bool> warm_one_connection(
+            const std::shared_ptr<Node>& node,
+            std::size_t max_pool);
+
+        static task::Awaitable<void> warm_up_worker(std::shared_ptr<WarmUp> st);
+
+        task::Awaitable<void> warm_up(std::vector<std::shared_ptr<Node>> nodes);
+
+        task::Awaitable<RedisResult<PooledClient>>
+        acquire_from_node(const std::shared_ptr<Node>& node, bool shared = false);
+
+        static void return_to_pool(
+            const std::shared_ptr<Node>& node,
+            std::shared_ptr<RedisClient>&& client,
+            bool faulty) noexcept;
+
+        task::Awaitable<void>
+        release_pooled(PooledClient&& pc, bool faulty);
+
+        // shared: hand out a multiplexed connection when configured, see execute_on.
+        task::Awaitable<RedisResult<PooledClient>> acquire_for_slot(int slot, bool shared = false);
+        task::Awaitable<RedisResult<PooledClient>> acquire_for_any(bool shared = false);
+        task::Awaitable<RedisResult<PooledClient>> acquire_for_key(std::string_view key, bool shared = false);
+        task::Awaitable<RedisResult<PooledClient>> acquire_for_read(std::string_view key, bool shared = false);
+
+        std::vector<std::shared_ptr<Node>> nodes_for_scope_locked(NodeScope scope) const;
+
+        task::Awaitable<std::vector<RedisNodeReply>> fan_out(
+            std::vector<std::shared_ptr<Node>> nodes,
+            IndexedNodeCallback fn,
+            std::size_t max_concurrency);
+
+        task::Awaitable<void> fan_out_worker(std::shared_ptr<FanOut> st);
+
+        static RedisResult<void> first_error(const std::vector<RedisNodeReply>& replies);
+
+        task::Awaitable<RedisResult<RedisValue>> execute_on(
+            PooledClient& pc,
+            std::string_view cmd,
+            std::span<const std::string_view> args);
+
+        task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue>>>> pipeline_on(
+            PooledClient& pc,
+            std::span<const RedisCommandView> cmds);
+
+        static RedisResult<Topology> parse_cluster_slots(const RedisValue& v, const RedisClusterNode& via);
+        static RedisResult<Topology> parse_cluster_shards(const RedisValue& v, const RedisClusterNode& via);
+
+        task::Awaitable<RedisResult<Topology>> fetch_topology(RedisClient& client, const RedisClusterNode& via);
+        bool apply_topology_locked(const Topology& topo);
+
+        task::Awaitable<RedisResult<void>> initial_discovery();
+        task::Awaitable<RedisResult<void>> refresh_topology_from(RedisClient& client, const RedisClusterNode& via);
+
+        void mark_topology_refreshed() noexcept;
+        void note_moved();
+        task::Awaitable<void> topology_refresh_task(std::shared_ptr<Impl> self);
+        task::Awaitable<void> topology_periodic_loop(std::shared_ptr<Impl> self);
+
+        task::Awaitable<void> apply_moved(const Redirection& r);
+
+        static bool is_master_role(const RedisValue& role);
+        bool promote_replica_locked(const std::shared_ptr<Node>& node);
+        task::Awaitable<void> probe_standbys();
+        task::Awaitable<void> standby_loop(std::shared_ptr<Impl> self);
+
+        void clear_migrating_locked() noexcept;
+        task::Awaitable<void> note_ask(const Redirection& r, std::string_view key);
+        task::Awaitable<std::optional<Redirection>> known_ask_target(std::string_view key);
+
+        task::Awaitable<RedisResult<RedisValue>> execute_ask(
+            const Redirection& r,
+            std::string_view cmd,
+            std::span<const std::string_view> args);
+    };
+
     static bool is_cluster_disabled_error(const RedisError &e) {
         if (e.category != RedisErrorCategory::ServerReply)
             return false;
@@ -27,7 +324,7 @@ namespace usub::uredis {
                    m.find("unknown") != std::string::npos);
     }
 
-    bool RedisClusterClient::is_slot_mapping_empty_error(const RedisError &e) noexcept {
+    bool RedisClusterClient::Impl::is_slot_mapping_empty_error(const RedisError &e) noexcept {
         if (e.category != RedisErrorCategory::Protocol)
             return false;
 
@@ -36,7 +333,53 @@ namespace usub::uredis {
                || e.message.find("CLUSTER SLOTS returned no slot ranges") != std::string::npos;
     }
 
-    RedisClusterClient::RedisClusterClient(RedisClusterConfig cfg)
+    // Commands carrying the `readonly` flag in COMMAND INFO, upper-case and sorted.
+    static constexpr std::string_view readonly_commands[] = {
+        "BITCOUNT", "BITFIELD_RO", "BITPOS", "DUMP", "EVALSHA_RO", "EVAL_RO", "EXISTS",
+        "EXPIRETIME", "FCALL_RO", "GEODIST", "GEOHASH", "GEOPOS", "GEORADIUSBYMEMBER_RO",
+        "GEORADIUS_RO", "GEOSEARCH", "GET", "GETBIT", "GETRANGE", "HEXISTS", "HGET", "HGETALL",
+        "HKEYS", "HLEN", "HMGET", "HRANDFIELD", "HSCAN", "HSTRLEN", "HVALS", "LCS", "LINDEX",
+        "LLEN", "LPOS", "LRANGE", "MGET", "PEXPIRETIME", "PFCOUNT", "PTTL", "SCARD", "SDIFF",
+        "SINTER", "SINTERCARD", "SISMEMBER", "SMEMBERS", "SMISMEMBER", "SORT_RO", "SRANDMEMBER",
+        "SSCAN", "STRLEN", "SUBSTR", "SUNION", "TOUCH", "TTL", "TYPE", "XLEN", "XRANGE", "XREAD",
+        "XREVRANGE", "ZCARD", "ZCOUNT", "ZDIFF", "ZINTER", "ZINTERCARD", "ZLEXCOUNT", "ZMSCORE",
+        "ZRANDMEMBER", "ZRANGE", "ZRANGEBYLEX", "ZRANGEBYSCORE", "ZRANK", "ZREVRANGE",
+        "ZREVRANGEBYLEX", "ZREVRANGEBYSCORE", "ZREVRANK", "ZSCAN", "ZSCORE", "ZUNION",
+    };
+
+    bool RedisClusterClient::Impl::is_readonly_command(std::string_view cmd) noexcept {
+        char buf[32];
+        if (cmd.empty() || cmd.size() > sizeof(buf))
+            return false;
+
+        for (std::size_t i = 0; i < cmd.size(); ++i)
+            buf[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(cmd[i])));
+
+        return std::binary_search(
+            std::begin(readonly_commands), std::end(readonly_commands),
+            std::string_view{buf, cmd.size()});
+    }
+
+    void RedisClusterClient::Node::observe_latency(std::uint64_t us) noexcept {
+        auto cur = latency_ewma_us.load(std::memory_order_relaxed);
+        for (;;) {
+            // alpha = 1/8, the same smoothing TCP uses for SRTT
+            const std::uint64_t next = cur == 0
+                                           ? us
+                                           : static_cast<std::uint64_t>(
+                                               static_cast<std::int64_t>(cur) +
+                                               (static_cast<std::int64_t>(us) - static_cast<std::int64_t>(cur)) / 8);
+            if (latency_ewma_us.compare_exchange_weak(cur, next, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    std::uint64_t RedisClusterClient::Node::load_score() const noexcept {
+        return (latency_ewma_us.load(std::memory_order_relaxed) + 1) *
+               (inflight.load(std::memory_order_relaxed) + 1);
+    }
+
+    RedisClusterClient::Impl::Impl(RedisClusterConfig cfg)
         : cfg_(std::move(cfg)) {
         slot_to_node_.fill(-1);
 
@@ -44,6 +387,8 @@ namespace usub::uredis {
             cfg_.max_redirections = 5;
         if (cfg_.max_connections_per_node == 0)
             cfg_.max_connections_per_node = 1;
+        if (cfg_.topology_min_refresh_interval_ms < 0)
+            cfg_.topology_min_refresh_interval_ms = 0;
 
         normalize_auth(cfg_.username);
         normalize_auth(cfg_.password);
@@ -54,32 +399,19 @@ namespace usub::uredis {
 #endif
     }
 
-    std::string_view RedisClusterClient::extract_hash_tag(std::string_view key) {
-        auto l = key.find('{');
-        if (l == std::string_view::npos) return key;
-        auto r = key.find('}', l + 1);
-        if (r == std::string_view::npos || r == l + 1) return key;
-        return key.substr(l + 1, r - l - 1);
+    void RedisClusterClient::Impl::shutdown() noexcept {
+        alive_->store(false, std::memory_order_release);
+        bg_.stopping.store(true);
     }
 
-    std::uint16_t RedisClusterClient::calc_slot(std::string_view key) {
-        if (key.empty()) return 0;
-
-        std::uint16_t crc = 0;
-        for (unsigned char b: key) {
-            crc ^= static_cast<std::uint16_t>(b) << 8;
-            for (int i = 0; i < 8; ++i) {
-                if (crc & 0x8000)
-                    crc = static_cast<std::uint16_t>((crc << 1) ^ 0x1021);
-                else
-                    crc = static_cast<std::uint16_t>(crc << 1);
-            }
-        }
-        return static_cast<std::uint16_t>(crc % 16384);
+    task::Awaitable<void> RedisClusterClient::Impl::stop() {
+        shutdown();
+        if (bg_.running.load() > 0)
+            co_await bg_.idle.wait();
     }
 
-    std::optional<RedisClusterClient::Redirection>
-    RedisClusterClient::parse_redirection(const std::string &msg) {
+    std::optional<RedisClusterClient::Impl::Redirection>
+    RedisClusterClient::Impl::parse_redirection(const std::string &msg) {
         std::string_view s{msg};
 
         auto next_token = [](std::string_view &str) -> std::string_view {
@@ -134,7 +466,7 @@ namespace usub::uredis {
         };
     }
 
-    RedisResult<int> RedisClusterClient::node_index_for_slot_locked(int slot) const {
+    RedisResult<int> RedisClusterClient::Impl::node_index_for_slot_locked(int slot) const {
         if (slot < 0 || slot >= 16384)
             return std::unexpected(
                 RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: invalid slot"});
@@ -147,7 +479,7 @@ namespace usub::uredis {
         return idx;
     }
 
-    RedisResult<int> RedisClusterClient::node_index_for_key_locked(std::string_view key) const {
+    RedisResult<int> RedisClusterClient::Impl::node_index_for_key_locked(std::string_view key) const {
         if (nodes_.empty())
             return std::unexpected(
                 RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: no nodes"});
@@ -155,17 +487,10 @@ namespace usub::uredis {
         if (key.empty())
             return 0;
 
-        auto tag = extract_hash_tag(key);
-        auto slot = calc_slot(tag);
-        return node_index_for_slot_locked(static_cast<int>(slot));
+        return node_index_for_slot_locked(static_cast<int>(slot_of(key)));
     }
 
-    int RedisClusterClient::ensure_node_locked(std::string_view host, std::uint16_t port) {
-        for (std::size_t i = 0; i < nodes_.size(); ++i) {
-            if (nodes_[i]->cfg.host == host && nodes_[i]->cfg.port == port)
-                return static_cast<int>(i);
-        }
-
+    RedisConfig RedisClusterClient::Impl::node_config(std::string_view host, std::uint16_t port) const {
         RedisConfig ncfg;
         ncfg.host = std::string(host);
         ncfg.port = port;
@@ -174,47 +499,93 @@ namespace usub::uredis {
         ncfg.password = cfg_.password;
         ncfg.connect_timeout_ms = cfg_.connect_timeout_ms;
         ncfg.io_timeout_ms = cfg_.io_timeout_ms;
+        return ncfg;
+    }
+
+    task::Awaitable<RedisResult<RedisClusterNode> > RedisClusterClient::Impl::master_for_slot(int slot) {
+        auto init = co_await connect();
+        if (!init) co_return std::unexpected(init.error());
+
+        auto g = co_await mutex_.lock();
+        auto idx = node_index_for_slot_locked(slot);
+        if (!idx) co_return std::unexpected(idx.error());
+
+        const auto &n = nodes_[static_cast<std::size_t>(*idx)];
+        co_return RedisClusterNode{n->cfg.host, n->cfg.port};
+    }
+
+    int RedisClusterClient::Impl::ensure_node_locked(std::string_view host, std::uint16_t port, bool replica) {
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i]->cfg.host == host && nodes_[i]->cfg.port == port) {
+                nodes_[i]->replica.store(replica, std::memory_order_relaxed);
+                return static_cast<int>(i);
+            }
+        }
+
+        RedisConfig ncfg = node_config(host, port);
+        // READONLY is a no-op on masters, so a node keeps working across role changes.
+        ncfg.readonly = cfg_.read_preference != ReadPreference::Master;
 
-        nodes_.push_back(std::make_shared<Node>(ncfg, cfg_.max_connections_per_node));
+        auto node = std::make_shared<Node>(ncfg, cfg_);
+        node->replica.store(replica, std::memory_order_relaxed);
+        nodes_.push_back(std::move(node));
         return static_cast<int>(nodes_.size() - 1);
     }
 
-    void RedisClusterClient::setup_standalone_locked() {
+    int RedisClusterClient::Impl::pick_read_node_locked(int master_idx) const {
+        if (cfg_.read_preference == ReadPreference::Master || standalone_mode_)
+            return master_idx;
+
+        int best = -1;
+        std::uint64_t best_score = std::numeric_limits<std::uint64_t>::max();
+
+        if (static_cast<std::size_t>(master_idx) < replicas_of_.size()) {
+            for (int r: replicas_of_[static_cast<std::size_t>(master_idx)]) {
+                const auto &n = nodes_[static_cast<std::size_t>(r)];
+                if (!n->replica.load(std::memory_order_relaxed))
+                    continue;
+                const auto score = n->load_score();
+                if (score < best_score) {
+                    best_score = score;
+                    best = r;
+                }
+            }
+        }
+
+        switch (cfg_.read_preference) {
+            case ReadPreference::ReplicaOnly:
+                return best;
+            case ReadPreference::Nearest:
+                if (best < 0 || nodes_[static_cast<std::size_t>(master_idx)]->load_score() <= best_score)
+                    return master_idx;
+                return best;
+            default:
+                return best >= 0 ? best : master_idx;
+        }
+    }
+
+    void RedisClusterClient::Impl::setup_standalone_locked() {
         if (nodes_.empty()) {
             for (const auto &s: cfg_.seeds) {
-                RedisConfig ncfg;
-                ncfg.host = s.host;
-                ncfg.port = s.port;
-                ncfg.db = 0;
-                ncfg.username = cfg_.username;
-                ncfg.password = cfg_.password;
-                ncfg.connect_timeout_ms = cfg_.connect_timeout_ms;
-                ncfg.io_timeout_ms = cfg_.io_timeout_ms;
-
-                nodes_.push_back(std::make_shared<Node>(ncfg, cfg_.max_connections_per_node));
+                RedisConfig ncfg = node_config(s.host, s.port);
+                nodes_.push_back(std::make_shared<Node>(ncfg, cfg_));
             }
         }
 
         slot_to_node_.fill(0);
+        replicas_of_.clear();
         standalone_mode_ = true;
     }
 
-    bool RedisClusterClient::has_full_slot_mapping_locked() const noexcept {
+    bool RedisClusterClient::Impl::has_full_slot_mapping_locked() const noexcept {
         return std::all_of(
             slot_to_node_.begin(), slot_to_node_.end(),
             [](int x) { return x >= 0; });
     }
 
     task::Awaitable<RedisResult<std::shared_ptr<RedisClient> > >
-    RedisClusterClient::connect_to_node(std::string_view host, std::uint16_t port) {
-        RedisConfig cfg;
-        cfg.host = std::string(host);
-        cfg.port = port;
-        cfg.db = 0;
-        cfg.username = cfg_.username;
-        cfg.password = cfg_.password;
-        cfg.connect_timeout_ms = cfg_.connect_timeout_ms;
-        cfg.io_timeout_ms = cfg_.io_timeout_ms;
+    RedisClusterClient::Impl::connect_to_node(std::string_view host, std::uint16_t port) {
+        RedisConfig cfg = node_config(host, port);
 
 #ifdef UREDIS_LOGS
         ulog::warn("connect_to_node: cluster_pass={} local_pass={}",
@@ -228,39 +599,144 @@ namespace usub::uredis {
         co_return cli;
     }
 
-    task::Awaitable<void> RedisClusterClient::warm_pool_fill_to_max(
-        const RedisClusterConfig &cfg,
-        const std::shared_ptr<Node> &node) {
-        for (;;) {
-            auto cur = node->live_count.load(std::memory_order_relaxed);
-            if (cur >= cfg.max_connections_per_node)
-                co_return;
+    struct RedisClusterClient::Impl::WarmUp {
+        struct Job {
+            std::shared_ptr<Node> node;
+            std::size_t node_idx{0};
+            int mux{-1}; // >= 0: multiplexed connection index, else one pooled connection
+            bool first{false};
+        };
 
-            if (!node->live_count.compare_exchange_strong(
-                cur, cur + 1,
-                std::memory_order_acq_rel, std::memory_order_relaxed))
-                continue;
+        std::vector<Job> jobs;
+        std::unique_ptr<std::atomic<bool>[]> node_failed;
+        std::size_t max_pool{0};
+        std::shared_ptr<std::atomic<bool> > alive;
+
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> workers{0};
+        std::atomic<std::size_t> first_left{0};
+        sync::AsyncEvent done{sync::Reset::Manual, false};
+        sync::AsyncEvent first_done{sync::Reset::Manual, false};
+    };
+
+    task::Awaitable<bool> RedisClusterClient::Impl::warm_one_connection(
+        const std::shared_ptr<Node> &node,
+        std::size_t max_pool) {
+        auto cur = node->live_count.load(std::memory_order_relaxed);
+        do {
+            if (cur >= max_pool)
+                co_return true;
+        } while (!node->live_count.compare_exchange_weak(
+            cur, cur + 1,
+            std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        auto cli = std::make_shared<RedisClient>(node->cfg);
+        auto c = co_await cli->connect();
+        if (!c || !node->idle.try_enqueue(cli)) {
+            node->live_count.fetch_sub(1, std::memory_order_relaxed);
+            node->notify_waiters_if_any();
+            co_return false;
+        }
 
-            auto cli = std::make_shared<RedisClient>(node->cfg);
-            auto c = co_await cli->connect();
-            if (!c) {
-                node->live_count.fetch_sub(1, std::memory_order_relaxed);
-                node->notify_waiters_if_any();
-                co_return;
+        node->idle_sem.release();
+        co_return true;
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::warm_up_worker(std::shared_ptr<WarmUp> st) {
+        for (;;) {
+            const auto i = st->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= st->jobs.size())
+                break;
+
+            const auto &job = st->jobs[i];
+            if (st->alive->load(std::memory_order_acquire)
+                && !st->node_failed[job.node_idx].load(std::memory_order_relaxed)) {
+                bool ok;
+                if (job.mux >= 0)
+                    ok = static_cast<bool>(co_await job.node->mux[static_cast<std::size_t>(job.mux)]->connect());
+                else
+                    ok = co_await warm_one_connection(job.node, st->max_pool);
+
+                // a node that refuses one connection would refuse the rest as well
+                if (!ok)
+                    st->node_failed[job.node_idx].store(true, std::memory_order_relaxed);
             }
 
-            if (!node->idle.try_enqueue(cli)) {
-                node->live_count.fetch_sub(1, std::memory_order_relaxed);
-                node->notify_waiters_if_any();
-                co_return;
+            if (job.first && st->first_left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                st->first_done.set();
+        }
+
+        if (st->workers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            st->done.set();
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::warm_up(std::vector<std::shared_ptr<Node> > nodes) {
+        auto st = std::make_shared<WarmUp>();
+        st->max_pool = cfg_.max_connections_per_node;
+        st->alive = alive_;
+        st->node_failed = std::make_unique<std::atomic<bool>[]>(nodes.size());
+
+        // Round-robin over nodes so that every node gets its first connection before any node
+        // gets its second one.
+        std::vector<std::vector<WarmUp::Job> > per_node(nodes.size());
+        std::size_t rounds = 0;
+        for (std::size_t n = 0; n < nodes.size(); ++n) {
+            const auto &node = nodes[n];
+            auto &list = per_node[n];
+
+            for (std::size_t m = 0; m < node->mux.size(); ++m)
+                list.push_back(WarmUp::Job{node, n, static_cast<int>(m), false});
+
+            const auto live = node->live_count.load(std::memory_order_relaxed);
+            for (std::size_t c = live; c < cfg_.max_connections_per_node; ++c)
+                list.push_back(WarmUp::Job{node, n, -1, false});
+
+            if (!list.empty()) {
+                list.front().first = true;
+                st->first_left.fetch_add(1, std::memory_order_relaxed);
             }
+            rounds = std::max(rounds, list.size());
+        }
 
-            node->idle_sem.release();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (auto &list: per_node) {
+                if (r < list.size())
+                    st->jobs.push_back(list[r]);
+            }
         }
+
+        if (st->jobs.empty())
+            co_return;
+
+        std::size_t workers = st->jobs.size();
+        if (cfg_.warmup_concurrency > 0 && cfg_.warmup_concurrency < workers)
+            workers = cfg_.warmup_concurrency;
+        st->workers.store(workers, std::memory_order_relaxed);
+
+        for (std::size_t w = 0; w < workers; ++w)
+            system::co_spawn(warm_up_worker(st));
+
+        if (cfg_.warmup_first_connection_only)
+            co_await st->first_done.wait();
+        else
+            co_await st->done.wait();
     }
 
-    task::Awaitable<RedisResult<RedisClusterClient::PooledClient> >
-    RedisClusterClient::acquire_from_node(const std::shared_ptr<Node> &node) {
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::PooledClient> >
+    RedisClusterClient::Impl::acquire_from_node(const std::shared_ptr<Node> &node, bool shared) {
+        if (shared && !node->mux.empty()) {
+            auto best = node->mux.front();
+            for (const auto &m: node->mux) {
+                if (m->inflight() < best->inflight())
+                    best = m;
+            }
+
+            auto c = co_await best->connect();
+            if (!c)
+                co_return std::unexpected(c.error());
+            co_return PooledClient{node, nullptr, std::move(best)};
+        }
+
         std::shared_ptr<RedisClient> client;
 
         for (;;) {
@@ -273,7 +749,7 @@ namespace usub::uredis {
                     continue;
                 }
 
-                co_return PooledClient{node, std::move(client)};
+                co_return PooledClient{node, std::move(client), nullptr};
             }
 
             auto cur = node->live_count.load(std::memory_order_relaxed);
@@ -288,7 +764,7 @@ namespace usub::uredis {
                         node->notify_waiters_if_any();
                         co_return std::unexpected(c.error());
                     }
-                    co_return PooledClient{node, std::move(cli)};
+                    co_return PooledClient{node, std::move(cli), nullptr};
                 }
                 continue;
             }
@@ -299,31 +775,74 @@ namespace usub::uredis {
         }
     }
 
-    task::Awaitable<void>
-    RedisClusterClient::release_pooled(PooledClient &&pc, bool faulty) {
-        auto node = std::move(pc.node);
-        auto client = std::move(pc.client);
-
+    void RedisClusterClient::Impl::return_to_pool(
+        const std::shared_ptr<Node> &node,
+        std::shared_ptr<RedisClient> &&client,
+        bool faulty) noexcept {
         if (!node || !client)
-            co_return;
+            return;
 
         if (faulty || !client->connected() || !client->is_idle()) {
             node->live_count.fetch_sub(1, std::memory_order_relaxed);
             node->notify_waiters_if_any();
-            co_return;
+            return;
         }
 
-        if (!node->idle.try_enqueue(client)) {
+        if (!node->idle.try_enqueue(std::move(client))) {
             node->live_count.fetch_sub(1, std::memory_order_relaxed);
             node->notify_waiters_if_any();
-            co_return;
+            return;
         }
 
         node->idle_sem.release();
     }
 
-    task::Awaitable<RedisResult<RedisClusterClient::PooledClient> >
-    RedisClusterClient::acquire_for_slot(int slot) {
+    task::Awaitable<void>
+    RedisClusterClient::Impl::release_pooled(PooledClient &&pc, bool faulty) {
+        // multiplexed connections are shared and reconnect on their own
+        if (pc.mux)
+            co_return;
+
+        auto node = std::move(pc.node);
+        return_to_pool(node, std::move(pc.client), faulty);
+        co_return;
+    }
+
+    RedisClusterClient::ClientLease::ClientLease(ClientLease &&other) noexcept
+        : node_(std::move(other.node_))
+        , client_(std::move(other.client_))
+        , faulty_(other.faulty_) {
+        other.faulty_ = false;
+    }
+
+    RedisClusterClient::ClientLease &
+    RedisClusterClient::ClientLease::operator=(ClientLease &&other) noexcept {
+        if (this != &other) {
+            release();
+            node_ = std::move(other.node_);
+            client_ = std::move(other.client_);
+            faulty_ = other.faulty_;
+            other.faulty_ = false;
+        }
+        return *this;
+    }
+
+    RedisClusterClient::ClientLease::~ClientLease() {
+        release();
+    }
+
+    void RedisClusterClient::ClientLease::release() noexcept {
+        if (!client_)
+            return;
+
+        auto node = std::move(node_);
+        Impl::return_to_pool(node, std::move(client_), faulty_);
+        client_.reset();
+        faulty_ = false;
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::PooledClient> >
+    RedisClusterClient::Impl::acquire_for_slot(int slot, bool shared) {
         auto init = co_await connect();
         if (!init) co_return std::unexpected(init.error());
 
@@ -339,11 +858,11 @@ namespace usub::uredis {
             node = nodes_[static_cast<std::size_t>(*idx)];
         }
 
-        co_return co_await acquire_from_node(node);
+        co_return co_await acquire_from_node(node, shared);
     }
 
-    task::Awaitable<RedisResult<RedisClusterClient::PooledClient> >
-    RedisClusterClient::acquire_for_any() {
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::PooledClient> >
+    RedisClusterClient::Impl::acquire_for_any(bool shared) {
         auto init = co_await connect();
         if (!init) co_return std::unexpected(init.error());
 
@@ -356,16 +875,16 @@ namespace usub::uredis {
             node = nodes_.front();
         }
 
-        co_return co_await acquire_from_node(node);
+        co_return co_await acquire_from_node(node, shared);
     }
 
-    task::Awaitable<RedisResult<RedisClusterClient::PooledClient> >
-    RedisClusterClient::acquire_for_key(std::string_view key) {
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::PooledClient> >
+    RedisClusterClient::Impl::acquire_for_key(std::string_view key, bool shared) {
         auto init = co_await connect();
         if (!init) co_return std::unexpected(init.error());
 
         if (key.empty())
-            co_return co_await acquire_for_any();
+            co_return co_await acquire_for_any(shared);
 
         std::shared_ptr<Node> node;
         {
@@ -375,10 +894,82 @@ namespace usub::uredis {
             node = nodes_[static_cast<std::size_t>(*idx)];
         }
 
-        co_return co_await acquire_from_node(node);
+        co_return co_await acquire_from_node(node, shared);
     }
 
-    task::Awaitable<RedisResult<void> > RedisClusterClient::connect() {
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::PooledClient> >
+    RedisClusterClient::Impl::acquire_for_read(std::string_view key, bool shared) {
+        auto init = co_await connect();
+        if (!init) co_return std::unexpected(init.error());
+
+        std::shared_ptr<Node> node;
+        std::shared_ptr<Node> master;
+        {
+            auto g = co_await mutex_.lock();
+            auto idx = node_index_for_key_locked(key);
+            if (!idx) co_return std::unexpected(idx.error());
+            master = nodes_[static_cast<std::size_t>(*idx)];
+
+            int r = pick_read_node_locked(*idx);
+            if (r < 0)
+                co_return std::unexpected(
+                    RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: no replica available for slot"});
+            node = nodes_[static_cast<std::size_t>(r)];
+        }
+
+        auto pc = co_await acquire_from_node(node, shared);
+        if (pc || node == master || cfg_.read_preference == ReadPreference::ReplicaOnly)
+            co_return pc;
+
+        co_return co_await acquire_from_node(master, shared);
+    }
+
+    task::Awaitable<RedisResult<RedisValue> >
+    RedisClusterClient::Impl::execute_on(
+        PooledClient &pc,
+        std::string_view cmd,
+        std::span<const std::string_view> args) {
+        auto &node = *pc.node;
+        node.inflight.fetch_add(1, std::memory_order_relaxed);
+        const auto started = std::chrono::steady_clock::now();
+
+        auto resp = pc.mux
+                        ? co_await pc.mux->command(cmd, args)
+                        : co_await pc.client->command(cmd, args);
+
+        node.inflight.fetch_sub(1, std::memory_order_relaxed);
+        if (resp || resp.error().category == RedisErrorCategory::ServerReply) {
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started).count();
+            node.observe_latency(static_cast<std::uint64_t>(us));
+        }
+
+        co_return resp;
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisClusterClient::Impl::pipeline_on(
+        PooledClient &pc,
+        std::span<const RedisCommandView> cmds) {
+        auto &node = *pc.node;
+        node.inflight.fetch_add(1, std::memory_order_relaxed);
+        const auto started = std::chrono::steady_clock::now();
+
+        auto resp = pc.mux
+                        ? co_await pc.mux->pipeline(cmds)
+                        : co_await pc.client->pipeline(cmds);
+
+        node.inflight.fetch_sub(1, std::memory_order_relaxed);
+        if (resp) {
+            const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started).count();
+            node.observe_latency(static_cast<std::uint64_t>(us));
+        }
+
+        co_return resp;
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::Impl::connect() {
         bool we_init = false;
 
         {
@@ -405,189 +996,325 @@ namespace usub::uredis {
             init_event_.set();
         }
 
+        // each task starts with a ticket taken here
+        if (res && cfg_.topology_refresh_interval_ms > 0 && !cfg_.force_standalone && bg_.enter())
+            system::co_spawn(topology_periodic_loop(shared_from_this()));
+        if (res && cfg_.replica_standby && !cfg_.force_standalone && bg_.enter())
+            system::co_spawn(standby_loop(shared_from_this()));
+
         co_return res;
     }
 
-    task::Awaitable<RedisResult<void> > RedisClusterClient::initial_discovery() {
-        if (cfg_.seeds.empty())
-            co_return std::unexpected(
-                RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: seeds list is empty"});
+    static std::optional<std::string> reply_string(const RedisValue &x) {
+        if (x.is_bulk_string() || x.is_simple_string())
+            return x.as_string();
+        return std::nullopt;
+    }
 
-        if (cfg_.force_standalone) {
-            std::vector<std::shared_ptr<Node> > snap;
-            {
-                auto g = co_await mutex_.lock();
-                setup_standalone_locked();
-                snap = nodes_;
-            }
-            for (const auto &n: snap)
-                co_await warm_pool_fill_to_max(cfg_, n);
-            co_return RedisResult<void>{};
-        }
+    static std::optional<RedisClusterNode> make_topology_node(
+        std::string host,
+        std::optional<int64_t> port_opt,
+        const RedisClusterNode &via) {
+        if (!port_opt || *port_opt <= 0 || *port_opt > 65535)
+            return std::nullopt;
+        if (host.empty() || host == "?")
+            host = via.host;
 
-        {
-            auto g = co_await mutex_.lock();
-            if (standalone_mode_) {
-                auto snap = nodes_;
-                g.unlock();
-                for (const auto &n: snap)
-                    co_await warm_pool_fill_to_max(cfg_, n);
-                co_return RedisResult<void>{};
-            }
-        }
+        auto port = static_cast<std::uint16_t>(*port_opt);
 
-        RedisError last_err{RedisErrorCategory::Io, "no attempts"};
+#ifdef UREDIS_PORT_FORWARD_SUPPORT
+        if (host == via.host && port != via.port)
+            port = via.port;
+#endif
 
-        for (const auto &seed: cfg_.seeds) {
-            auto mc = co_await connect_to_node(seed.host, seed.port);
-            if (!mc) {
-                last_err = mc.error();
-                continue;
+        return RedisClusterNode{std::move(host), port};
+    }
+
+    RedisResult<RedisClusterClient::Impl::Topology>
+    RedisClusterClient::Impl::parse_cluster_slots(const RedisValue &v, const RedisClusterNode &via) {
+        if (!v.is_array())
+            return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol,
+                "RedisClusterClient: CLUSTER SLOTS reply not array"
+            });
+
+        auto parse_node = [&via](const RedisValue &node_val) -> std::optional<RedisClusterNode> {
+            if (!node_val.is_array()) return std::nullopt;
+            const auto &arr = node_val.as_array();
+            if (arr.size() < 2) return std::nullopt;
+
+            std::string host;
+            if (!arr[0].is_null()) {
+                auto h = reply_string(arr[0]);
+                if (!h) return std::nullopt;
+                host = std::move(*h);
             }
 
-            auto &client = *mc;
+            return make_topology_node(std::move(host), arr[1].as_optional_integer(), via);
+        };
 
-            std::string_view slot_arg = "SLOTS";
-            std::array<std::string_view, 1> args_arr{slot_arg};
-            auto resp = co_await client->command(
-                "CLUSTER",
-                std::span<const std::string_view>(args_arr.data(), args_arr.size()));
+        Topology topo;
 
-            if (!resp) {
-                const auto &e = resp.error();
-                last_err = e;
+        for (const auto &range_val: v.as_array()) {
+            if (!range_val.is_array()) continue;
+            const auto &range_arr = range_val.as_array();
+            if (range_arr.size() < 3) continue;
 
-                if (is_cluster_disabled_error(e)) {
-                    std::vector<std::shared_ptr<Node> > snap;
-                    {
-                        auto g = co_await mutex_.lock();
-                        setup_standalone_locked();
-                        snap = nodes_;
-                    }
-                    for (const auto &n: snap)
-                        co_await warm_pool_fill_to_max(cfg_, n);
-                    co_return RedisResult<void>{};
-                }
-                continue;
+            auto start_opt = range_arr[0].as_optional_integer();
+            auto end_opt = range_arr[1].as_optional_integer();
+            if (!start_opt || !end_opt) continue;
+
+            ShardInfo shard;
+            shard.master = parse_node(range_arr[2]);
+            if (!shard.master) continue;
+
+            shard.ranges.emplace_back(*start_opt, *end_opt);
+
+            for (std::size_t i = 3; i < range_arr.size(); ++i) {
+                if (auto r = parse_node(range_arr[i]))
+                    shard.replicas.push_back(std::move(*r));
             }
 
-            const RedisValue &v = *resp;
-            if (!v.is_array()) {
-                last_err = RedisError{
-                    RedisErrorCategory::Protocol,
-                    "RedisClusterClient: CLUSTER SLOTS reply not array"
-                };
-                continue;
+            topo.push_back(std::move(shard));
+        }
+
+        return topo;
+    }
+
+    RedisResult<RedisClusterClient::Impl::Topology>
+    RedisClusterClient::Impl::parse_cluster_shards(const RedisValue &v, const RedisClusterNode &via) {
+        if (!v.is_array())
+            return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol,
+                "RedisClusterClient: CLUSTER SHARDS reply not array"
+            });
+
+        Topology topo;
+
+        for (const auto &shard_val: v.as_array()) {
+            if (!shard_val.is_array()) continue;
+            const auto &shard_kv = shard_val.as_array();
+
+            const RedisValue *slots = nullptr;
+            const RedisValue *nodes = nullptr;
+            for (std::size_t i = 0; i + 1 < shard_kv.size(); i += 2) {
+                auto key = reply_string(shard_kv[i]);
+                if (!key) continue;
+                if (*key == "slots") slots = &shard_kv[i + 1];
+                else if (*key == "nodes") nodes = &shard_kv[i + 1];
             }
 
-            const auto &slot_ranges = v.as_array();
+            if (!slots || !nodes || !slots->is_array() || !nodes->is_array())
+                continue;
 
-            if (slot_ranges.empty()) {
-                std::vector<std::shared_ptr<Node> > snap;
-                {
-                    auto g = co_await mutex_.lock();
-                    setup_standalone_locked();
-                    snap = nodes_;
-                }
-                for (const auto &n: snap)
-                    co_await warm_pool_fill_to_max(cfg_, n);
-                co_return RedisResult<void>{};
+            ShardInfo shard;
+
+            const auto &slot_arr = slots->as_array();
+            for (std::size_t i = 0; i + 1 < slot_arr.size(); i += 2) {
+                auto start_opt = slot_arr[i].as_optional_integer();
+                auto end_opt = slot_arr[i + 1].as_optional_integer();
+                if (start_opt && end_opt)
+                    shard.ranges.emplace_back(*start_opt, *end_opt);
             }
 
-            auto parse_i64 = [](const RedisValue &x) -> std::optional<int64_t> {
-                if (auto vv = x.as_optional_integer()) return *vv;
-                if (x.is_bulk_string() || x.is_simple_string()) {
-                    auto s = x.as_string();
-                    int64_t out = 0;
-                    auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
-                    (void) p;
-                    if (ec == std::errc{}) return out;
+            bool master_online = false;
+
+            for (const auto &node_val: nodes->as_array()) {
+                if (!node_val.is_array()) continue;
+                const auto &node_kv = node_val.as_array();
+
+                std::string ip, endpoint, role, health;
+                std::optional<int64_t> port, tls_port;
+
+                for (std::size_t i = 0; i + 1 < node_kv.size(); i += 2) {
+                    auto key = reply_string(node_kv[i]);
+                    if (!key) continue;
+
+                    const auto &val = node_kv[i + 1];
+                    if (*key == "ip") ip = reply_string(val).value_or("");
+                    else if (*key == "endpoint") endpoint = reply_string(val).value_or("");
+                    else if (*key == "role") role = reply_string(val).value_or("");
+                    else if (*key == "health") health = reply_string(val).value_or("");
+                    else if (*key == "port") port = val.as_optional_integer();
+                    else if (*key == "tls-port") tls_port = val.as_optional_integer();
                 }
-                return std::nullopt;
-            };
-
-            auto parse_host = [&seed](const RedisValue &x) -> std::optional<std::string> {
-                if (x.is_null()) return std::string(seed.host);
-                if (x.is_bulk_string() || x.is_simple_string()) {
-                    auto h = x.as_string();
-                    if (h.empty()) h = seed.host;
-                    return h;
+
+                auto addr = make_topology_node(
+                    !endpoint.empty() && endpoint != "?" ? endpoint : ip,
+                    port ? port : tls_port,
+                    via);
+                if (!addr) continue;
+
+                const bool online = health.empty() || health == "online";
+
+                if (role == "master") {
+                    if (!shard.master || (online && !master_online)) {
+                        shard.master = std::move(addr);
+                        master_online = online;
+                    }
+                } else if (online) {
+                    shard.replicas.push_back(std::move(*addr));
                 }
-                return std::nullopt;
-            };
+            }
 
-            bool ok_mapping = false;
-            std::vector<std::shared_ptr<Node> > nodes_snapshot;
-            std::array<int, 16384> new_map{};
-            new_map.fill(-1);
+            if (!shard.master || shard.ranges.empty())
+                continue;
 
-            {
-                auto guard = co_await mutex_.lock();
+            topo.push_back(std::move(shard));
+        }
 
-                auto ensure = [&](const RedisValue &node_val) -> std::optional<int> {
-                    if (!node_val.is_array()) return std::nullopt;
-                    const auto &arr = node_val.as_array();
-                    if (arr.size() < 2) return std::nullopt;
+        return topo;
+    }
 
-                    auto host_opt = parse_host(arr[0]);
-                    auto port_opt = parse_i64(arr[1]);
-                    if (!host_opt || !port_opt) return std::nullopt;
+    task::Awaitable<RedisResult<RedisClusterClient::Impl::Topology> >
+    RedisClusterClient::Impl::fetch_topology(RedisClient &client, const RedisClusterNode &via) {
+        if (shards_supported_.load(std::memory_order_relaxed)) {
+            std::array<std::string_view, 1> shards_args{"SHARDS"};
+            auto resp = co_await client.command(
+                "CLUSTER",
+                std::span<const std::string_view>(shards_args.data(), shards_args.size()));
 
-                    auto host = std::move(*host_opt);
-                    auto port_i = *port_opt;
-                    if (port_i <= 0 || port_i > 65535) return std::nullopt;
+            if (resp) {
+                auto topo = parse_cluster_shards(*resp, via);
+                if (topo && !topo->empty())
+                    co_return topo;
+            } else if (resp.error().category != RedisErrorCategory::ServerReply) {
+                co_return std::unexpected(resp.error());
+            } else {
+                // Redis < 7.0 or cluster disabled; CLUSTER SLOTS below tells which.
+                shards_supported_.store(false, std::memory_order_relaxed);
+            }
+        }
 
-                    auto port = static_cast<std::uint16_t>(port_i);
+        std::array<std::string_view, 1> slots_args{"SLOTS"};
+        auto resp = co_await client.command(
+            "CLUSTER",
+            std::span<const std::string_view>(slots_args.data(), slots_args.size()));
+        if (!resp)
+            co_return std::unexpected(resp.error());
 
-#ifdef UREDIS_PORT_FORWARD_SUPPORT
-                    if (host == seed.host && port != seed.port)
-                        port = seed.port;
-#endif
+        co_return parse_cluster_slots(*resp, via);
+    }
 
-                    return ensure_node_locked(host, port);
-                };
+    bool RedisClusterClient::Impl::apply_topology_locked(const Topology &topo) {
+        std::array<int, 16384> new_map{};
+        new_map.fill(-1);
+        std::vector<std::vector<int> > new_replicas;
 
-                for (const auto &range_val: slot_ranges) {
-                    if (!range_val.is_array()) continue;
-                    const auto &range_arr = range_val.as_array();
-                    if (range_arr.size() < 3) continue;
+        for (const auto &shard: topo) {
+            if (!shard.master) continue;
 
-                    auto start_opt = parse_i64(range_arr[0]);
-                    auto end_opt = parse_i64(range_arr[1]);
-                    if (!start_opt || !end_opt) continue;
+            const int master_idx = ensure_node_locked(shard.master->host, shard.master->port, false);
 
-                    auto start = *start_opt;
-                    auto end = *end_opt;
+            for (auto [start, end]: shard.ranges) {
+                if (start < 0) start = 0;
+                if (end > 16383) end = 16383;
+                for (int64_t s = start; s <= end; ++s)
+                    new_map[static_cast<std::size_t>(s)] = master_idx;
+            }
 
-                    auto master_idx = ensure(range_arr[2]);
-                    if (!master_idx) continue;
+            for (const auto &rep: shard.replicas) {
+                const int replica_idx = ensure_node_locked(rep.host, rep.port, true);
 
-                    if (start < 0) start = 0;
-                    if (end > 16383) end = 16383;
-                    if (end < start) continue;
+                if (new_replicas.size() <= static_cast<std::size_t>(master_idx))
+                    new_replicas.resize(static_cast<std::size_t>(master_idx) + 1);
+                auto &reps = new_replicas[static_cast<std::size_t>(master_idx)];
+                if (std::find(reps.begin(), reps.end(), replica_idx) == reps.end())
+                    reps.push_back(replica_idx);
+            }
+        }
 
-                    for (int64_t s = start; s <= end; ++s)
-                        new_map[static_cast<std::size_t>(s)] = *master_idx;
+        bool full = std::all_of(
+            new_map.begin(), new_map.end(),
+            [](int m) { return m >= 0; });
+        if (!full)
+            return false;
+
+        slot_to_node_ = new_map;
+        replicas_of_ = std::move(new_replicas);
+        clear_migrating_locked();
+        standalone_mode_ = false;
+        return true;
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::Impl::initial_discovery() {
+        if (cfg_.seeds.empty())
+            co_return std::unexpected(
+                RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: seeds list is empty"});
+
+        if (cfg_.force_standalone) {
+            std::vector<std::shared_ptr<Node> > snap;
+            {
+                auto g = co_await mutex_.lock();
+                setup_standalone_locked();
+                snap = nodes_;
+            }
+            co_await warm_up(std::move(snap));
+            co_return RedisResult<void>{};
+        }
+
+        {
+            auto g = co_await mutex_.lock();
+            if (standalone_mode_) {
+                auto snap = nodes_;
+                g.unlock();
+                co_await warm_up(std::move(snap));
+                co_return RedisResult<void>{};
+            }
+        }
+
+        RedisError last_err{RedisErrorCategory::Io, "no attempts"};
+
+        for (const auto &seed: cfg_.seeds) {
+            auto mc = co_await connect_to_node(seed.host, seed.port);
+            if (!mc) {
+                last_err = mc.error();
+                continue;
+            }
+
+            auto topo = co_await fetch_topology(**mc, seed);
+
+            if (!topo) {
+                const auto &e = topo.error();
+                last_err = e;
 
-                    for (std::size_t i = 3; i < range_arr.size(); ++i)
-                        (void) ensure(range_arr[i]);
+                if (is_cluster_disabled_error(e)) {
+                    std::vector<std::shared_ptr<Node> > snap;
+                    {
+                        auto g = co_await mutex_.lock();
+                        setup_standalone_locked();
+                        snap = nodes_;
+                    }
+                    co_await warm_up(std::move(snap));
+                    co_return RedisResult<void>{};
+                }
+                continue;
+            }
+
+            if (topo->empty()) {
+                std::vector<std::shared_ptr<Node> > snap;
+                {
+                    auto g = co_await mutex_.lock();
+                    setup_standalone_locked();
+                    snap = nodes_;
                 }
+                co_await warm_up(std::move(snap));
+                co_return RedisResult<void>{};
+            }
 
-                bool full = std::all_of(
-                    new_map.begin(), new_map.end(),
-                    [](int m) { return m >= 0; });
+            bool ok_mapping = false;
+            std::vector<std::shared_ptr<Node> > nodes_snapshot;
+
+            {
+                auto guard = co_await mutex_.lock();
 
-                if (full) {
-                    slot_to_node_ = new_map;
-                    standalone_mode_ = false;
+                if (apply_topology_locked(*topo)) {
+                    ok_mapping = true;
+                    nodes_snapshot = nodes_;
+                } else if (!has_full_slot_mapping_locked()) {
+                    setup_standalone_locked();
                     ok_mapping = true;
                     nodes_snapshot = nodes_;
-                } else {
-                    if (!has_full_slot_mapping_locked()) {
-                        setup_standalone_locked();
-                        ok_mapping = true;
-                        nodes_snapshot = nodes_;
-                    }
                 }
             }
 
@@ -599,8 +1326,9 @@ namespace usub::uredis {
                 continue;
             }
 
-            for (const auto &n: nodes_snapshot)
-                co_await warm_pool_fill_to_max(cfg_, n);
+            mark_topology_refreshed();
+
+            co_await warm_up(std::move(nodes_snapshot));
 
             co_return RedisResult<void>{};
         }
@@ -611,29 +1339,320 @@ namespace usub::uredis {
         });
     }
 
-    task::Awaitable<RedisResult<void> > RedisClusterClient::rediscover_slots_serialized() {
+    task::Awaitable<RedisResult<void> >
+    RedisClusterClient::Impl::refresh_topology_from(RedisClient &client, const RedisClusterNode &via) {
+        auto topo = co_await fetch_topology(client, via);
+        if (!topo)
+            co_return std::unexpected(topo.error());
+
+        {
+            auto g = co_await mutex_.lock();
+            if (!apply_topology_locked(*topo))
+                co_return std::unexpected(RedisError{
+                    RedisErrorCategory::Protocol,
+                    "RedisClusterClient: CLUSTER SLOTS returned incomplete slot coverage"
+                });
+        }
+
+        mark_topology_refreshed();
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::Impl::refresh_topology() {
         auto guard = co_await rediscover_mutex_.lock();
 
+        std::vector<std::shared_ptr<Node> > masters;
         {
             auto g = co_await mutex_.lock();
             if (standalone_mode_ || cfg_.force_standalone)
                 co_return RedisResult<void>{};
+
+            for (const auto &n: nodes_) {
+                if (!n->replica.load(std::memory_order_relaxed))
+                    masters.push_back(n);
+            }
         }
 
-        co_return co_await initial_discovery();
+        RedisError last_err{RedisErrorCategory::Io, "no attempts"};
+
+        for (const auto &node: masters) {
+            auto pc = co_await acquire_from_node(node);
+            if (!pc) {
+                last_err = pc.error();
+                continue;
+            }
+
+            auto r = co_await refresh_topology_from(
+                *pc->client, RedisClusterNode{node->cfg.host, node->cfg.port});
+            const bool faulty = !r && r.error().category == RedisErrorCategory::Io;
+            co_await release_pooled(std::move(*pc), faulty);
+
+            if (r) co_return r;
+            last_err = r.error();
+        }
+
+        for (const auto &seed: cfg_.seeds) {
+            auto mc = co_await connect_to_node(seed.host, seed.port);
+            if (!mc) {
+                last_err = mc.error();
+                continue;
+            }
+
+            auto r = co_await refresh_topology_from(**mc, seed);
+            if (r) co_return r;
+            last_err = r.error();
+        }
+
+#ifdef UREDIS_LOGS
+        ulog::warn("RedisClusterClient::refresh_topology: failed, last={}", last_err.message);
+#endif
+
+        co_return std::unexpected(RedisError{
+            last_err.category,
+            std::string("RedisClusterClient: topology refresh failed on all nodes; last=") + last_err.message
+        });
     }
 
-    task::Awaitable<void> RedisClusterClient::apply_moved(const Redirection &r) {
+    static std::int64_t steady_now_ms() noexcept {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void RedisClusterClient::Impl::mark_topology_refreshed() noexcept {
+        last_refresh_ms_.store(steady_now_ms(), std::memory_order_relaxed);
+        moved_since_refresh_.store(0, std::memory_order_relaxed);
+    }
+
+    void RedisClusterClient::Impl::note_moved() {
+        const auto n = moved_since_refresh_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (cfg_.topology_moved_threshold > 0 && n >= cfg_.topology_moved_threshold)
+            schedule_topology_refresh();
+    }
+
+    void RedisClusterClient::Impl::schedule_topology_refresh() {
+        if (cfg_.force_standalone)
+            return;
+
+        refresh_pending_.store(true, std::memory_order_release);
+
+        bool expected = false;
+        if (!refresh_running_.compare_exchange_strong(
+            expected, true,
+            std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+
+        if (!bg_.enter()) {
+            refresh_running_.store(false, std::memory_order_release);
+            return;
+        }
+        system::co_spawn(topology_refresh_task(shared_from_this()));
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::topology_refresh_task(std::shared_ptr<Impl> self) {
+        auto &bg = self->bg_; // self keeps the state alive if the client goes away
+        while (refresh_pending_.exchange(false, std::memory_order_acq_rel)) {
+            const auto since = steady_now_ms() - last_refresh_ms_.load(std::memory_order_relaxed);
+            if (since < cfg_.topology_min_refresh_interval_ms) {
+                const auto delay = std::chrono::milliseconds(cfg_.topology_min_refresh_interval_ms - since);
+                bg.leave();
+                co_await system::this_coroutine::sleep_for(delay);
+                if (!bg.enter())
+                    co_return;
+                // triggers that arrived while throttled are served by this refresh
+                refresh_pending_.store(false, std::memory_order_relaxed);
+            }
+
+            (void) co_await refresh_topology();
+        }
+
+        refresh_running_.store(false, std::memory_order_release);
+
+        if (refresh_pending_.load(std::memory_order_acquire))
+            schedule_topology_refresh();
+
+        bg.leave();
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::topology_periodic_loop(std::shared_ptr<Impl> self) {
+        auto &bg = self->bg_;
+        const auto interval = std::chrono::milliseconds(cfg_.topology_refresh_interval_ms);
+
+        for (;;) {
+            bg.leave();
+            co_await system::this_coroutine::sleep_for(interval);
+            if (!bg.enter())
+                co_return;
+            schedule_topology_refresh();
+        }
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::apply_moved(const Redirection &r) {
         if (r.slot < 0 || r.slot >= 16384)
             co_return;
 
         auto g = co_await mutex_.lock();
         int idx = ensure_node_locked(r.host, r.port);
         slot_to_node_[static_cast<std::size_t>(r.slot)] = idx;
+
+        if (migrating_.erase(r.slot) > 0)
+            migrating_count_.store(migrating_.size(), std::memory_order_relaxed);
+    }
+
+    bool RedisClusterClient::Impl::is_master_role(const RedisValue &role) {
+        if (!role.is_array() || role.as_array().empty())
+            return false;
+        auto r = reply_string(role.as_array()[0]);
+        return r && *r == "master";
+    }
+
+    bool RedisClusterClient::Impl::promote_replica_locked(const std::shared_ptr<Node> &node) {
+        if (standalone_mode_ || !node->replica.load(std::memory_order_relaxed))
+            return false;
+
+        int idx = -1;
+        for (std::size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i] == node) {
+                idx = static_cast<int>(i);
+                break;
+            }
+        }
+
+        int old_master = -1;
+        for (std::size_t m = 0; m < replicas_of_.size() && idx >= 0; ++m) {
+            const auto &reps = replicas_of_[m];
+            if (std::find(reps.begin(), reps.end(), idx) != reps.end()) {
+                old_master = static_cast<int>(m);
+                break;
+            }
+        }
+        if (old_master < 0)
+            return false;
+
+        for (auto &owner: slot_to_node_) {
+            if (owner == old_master)
+                owner = idx;
+        }
+
+        // The old master is left out of routing until a refresh sees it again (as a replica).
+        auto reps = std::move(replicas_of_[static_cast<std::size_t>(old_master)]);
+        replicas_of_[static_cast<std::size_t>(old_master)].clear();
+        reps.erase(std::remove(reps.begin(), reps.end(), idx), reps.end());
+        if (replicas_of_.size() <= static_cast<std::size_t>(idx))
+            replicas_of_.resize(static_cast<std::size_t>(idx) + 1);
+        replicas_of_[static_cast<std::size_t>(idx)] = std::move(reps);
+
+        node->replica.store(false, std::memory_order_relaxed);
+        nodes_[static_cast<std::size_t>(old_master)]->replica.store(true, std::memory_order_relaxed);
+        clear_migrating_locked();
+
+#ifdef UREDIS_LOGS
+        ulog::warn("RedisClusterClient: replica {}:{} promoted, took over slots of {}:{}",
+                   node->cfg.host, node->cfg.port,
+                   nodes_[static_cast<std::size_t>(old_master)]->cfg.host,
+                   nodes_[static_cast<std::size_t>(old_master)]->cfg.port);
+#endif
+        return true;
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::probe_standbys() {
+        std::vector<std::shared_ptr<Node> > replicas;
+        {
+            auto g = co_await mutex_.lock();
+            if (standalone_mode_)
+                co_return;
+            replicas = nodes_for_scope_locked(NodeScope::Replicas);
+        }
+        if (replicas.empty())
+            co_return;
+
+        // The probe goes through the pool, which keeps one connection per replica open; the
+        // first multiplexed connection is kept open as well since command() would use it.
+        auto replies = co_await fan_out(
+            replicas,
+            [&replicas](std::size_t i, RedisClient &c) -> task::Awaitable<RedisResult<RedisValue> > {
+                if (!replicas[i]->mux.empty())
+                    (void) co_await replicas[i]->mux.front()->connect();
+                co_return co_await c.command("ROLE");
+            },
+            cfg_.warmup_concurrency);
+
+        // the client went away while the probe ran: nobody routes through this state any more
+        if (bg_.stopping.load())
+            co_return;
+
+        bool promoted = false;
+        {
+            auto g = co_await mutex_.lock();
+            for (std::size_t i = 0; i < replies.size(); ++i) {
+                if (replies[i].result && is_master_role(*replies[i].result))
+                    promoted = promote_replica_locked(replicas[i]) || promoted;
+            }
+        }
+
+        // confirm the new layout (and pick up the old master as a replica once it is back)
+        if (promoted)
+            schedule_topology_refresh();
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::standby_loop(std::shared_ptr<Impl> self) {
+        auto &bg = self->bg_; // a probe in progress keeps the state alive through self
+        const auto interval = std::chrono::milliseconds(
+            std::max(cfg_.replica_standby_probe_interval_ms, 10));
+
+        for (;;) {
+            co_await probe_standbys();
+            bg.leave();
+            co_await system::this_coroutine::sleep_for(interval);
+            if (!bg.enter())
+                co_return;
+        }
+    }
+
+    void RedisClusterClient::Impl::clear_migrating_locked() noexcept {
+        migrating_.clear();
+        migrating_count_.store(0, std::memory_order_relaxed);
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::note_ask(const Redirection &r, std::string_view key) {
+        if (key.empty() || r.slot < 0 || r.slot >= 16384)
+            co_return;
+
+        auto g = co_await mutex_.lock();
+
+        auto it = migrating_.find(r.slot);
+        if (it == migrating_.end()) {
+            if (migrating_.size() >= max_migrating_slots)
+                co_return;
+            it = migrating_.emplace(r.slot, MigratingSlot{r.host, r.port, {}}).first;
+            migrating_count_.store(migrating_.size(), std::memory_order_relaxed);
+        } else if (it->second.host != r.host || it->second.port != r.port) {
+            // the slot is being imported by another node now
+            it->second.host = r.host;
+            it->second.port = r.port;
+            it->second.keys.clear();
+        }
+
+        if (it->second.keys.size() < max_migrated_keys_per_slot)
+            it->second.keys.emplace(key);
+    }
+
+    task::Awaitable<std::optional<RedisClusterClient::Impl::Redirection> >
+    RedisClusterClient::Impl::known_ask_target(std::string_view key) {
+        if (key.empty() || migrating_count_.load(std::memory_order_relaxed) == 0)
+            co_return std::nullopt;
+
+        const int slot = static_cast<int>(slot_of(key));
+
+        auto g = co_await mutex_.lock();
+        auto it = migrating_.find(slot);
+        if (it == migrating_.end() || !it->second.keys.contains(key))
+            co_return std::nullopt;
+
+        co_return Redirection{RedirType::Ask, slot, it->second.host, it->second.port};
     }
 
     task::Awaitable<RedisResult<RedisValue> >
-    RedisClusterClient::execute_ask(
+    RedisClusterClient::Impl::execute_ask(
         const Redirection &r,
         std::string_view cmd,
         std::span<const std::string_view> args) {
@@ -644,86 +1663,131 @@ namespace usub::uredis {
             node = nodes_[static_cast<std::size_t>(idx)];
         }
 
-        auto pc_res = co_await acquire_from_node(node);
+        auto pc_res = co_await acquire_from_node(node, true);
         if (!pc_res)
             co_return std::unexpected(pc_res.error());
 
         auto pc = std::move(*pc_res);
 
-        std::span<const std::string_view> no_args;
-        auto ask_resp = co_await pc.client->command("ASKING", no_args);
-        if (!ask_resp) {
+        // ASKING only applies to the next command on the connection; both go out in one frame.
+        const std::array<RedisCommandView, 2> frame{
+            RedisCommandView{"ASKING", {}},
+            RedisCommandView{cmd, args}
+        };
+
+        auto replies = co_await pipeline_on(pc, frame);
+        if (!replies) {
             co_await release_pooled(std::move(pc), true);
-            co_return std::unexpected(ask_resp.error());
+            co_return std::unexpected(replies.error());
         }
+        co_await release_pooled(std::move(pc), false);
 
-        auto resp = co_await pc.client->command(cmd, args);
-        bool faulty = !resp && resp.error().category != RedisErrorCategory::ServerReply;
-        co_await release_pooled(std::move(pc), faulty);
+        auto &asking = (*replies)[0];
+        if (!asking)
+            co_return std::unexpected(asking.error());
 
-        co_return resp;
+        co_return std::move((*replies)[1]);
     }
 
-    task::Awaitable<RedisResult<std::shared_ptr<RedisClient> > >
-    RedisClusterClient::get_client_for_key(std::string_view key) {
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::Impl::get_client_for_key(std::string_view key) {
+        auto pc = co_await acquire_for_key(key);
+        if (!pc) co_return std::unexpected(pc.error());
+        co_return ClientLease{std::move(pc->node), std::move(pc->client)};
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::Impl::get_any_client() {
+        auto pc = co_await acquire_for_any();
+        if (!pc) co_return std::unexpected(pc.error());
+        co_return ClientLease{std::move(pc->node), std::move(pc->client)};
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::Impl::get_client_for_slot(int slot) {
+        auto pc = co_await acquire_for_slot(slot);
+        if (!pc) co_return std::unexpected(pc.error());
+        co_return ClientLease{std::move(pc->node), std::move(pc->client)};
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeGroup> > >
+    RedisClusterClient::Impl::group_by_node(std::span<const std::string_view> keys) {
         auto init = co_await connect();
         if (!init) co_return std::unexpected(init.error());
 
-        if (key.empty())
-            co_return co_await get_any_client();
+        auto by_slot = group_by_slot(keys);
 
-        std::string host;
-        std::uint16_t port;
-        {
-            auto g = co_await mutex_.lock();
-            auto idx = node_index_for_key_locked(key);
+        std::vector<RedisNodeGroup> out;
+        std::vector<int> out_node;
+
+        auto g = co_await mutex_.lock();
+        for (auto &sg: by_slot) {
+            auto idx = node_index_for_slot_locked(sg.slot);
             if (!idx) co_return std::unexpected(idx.error());
-            host = nodes_[static_cast<std::size_t>(*idx)]->cfg.host;
-            port = nodes_[static_cast<std::size_t>(*idx)]->cfg.port;
+
+            auto pos = std::find(out_node.begin(), out_node.end(), *idx);
+            if (pos == out_node.end()) {
+                const auto &n = nodes_[static_cast<std::size_t>(*idx)];
+                out_node.push_back(*idx);
+                out.push_back(RedisNodeGroup{RedisClusterNode{n->cfg.host, n->cfg.port}, {}});
+                pos = out_node.end() - 1;
+            }
+            out[static_cast<std::size_t>(pos - out_node.begin())].slots.push_back(std::move(sg));
         }
 
-        co_return co_await connect_to_node(host, port);
+        co_return out;
     }
 
-    task::Awaitable<RedisResult<std::shared_ptr<RedisClient> > >
-    RedisClusterClient::get_any_client() {
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisClusterClient::Impl::execute_on_node(
+        const RedisClusterNode &node,
+        std::span<const RedisCommandView> cmds) {
         auto init = co_await connect();
         if (!init) co_return std::unexpected(init.error());
 
-        std::string host;
-        std::uint16_t port;
+        std::shared_ptr<Node> target;
         {
             auto g = co_await mutex_.lock();
-            if (nodes_.empty())
-                co_return std::unexpected(
-                    RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: no nodes"});
-            host = nodes_.front()->cfg.host;
-            port = nodes_.front()->cfg.port;
+            for (const auto &n: nodes_) {
+                if (n->cfg.host == node.host && n->cfg.port == node.port) {
+                    target = n;
+                    break;
+                }
+            }
+            if (!target)
+                target = nodes_[static_cast<std::size_t>(ensure_node_locked(node.host, node.port))];
         }
 
-        co_return co_await connect_to_node(host, port);
-    }
+        auto pc = co_await acquire_from_node(target, true);
+        if (!pc) {
+            if (pc.error().category == RedisErrorCategory::Io)
+                schedule_topology_refresh();
+            co_return std::unexpected(pc.error());
+        }
 
-    task::Awaitable<RedisResult<std::shared_ptr<RedisClient> > >
-    RedisClusterClient::get_client_for_slot(int slot) {
-        auto init = co_await connect();
-        if (!init) co_return std::unexpected(init.error());
+        auto replies = co_await pipeline_on(*pc, cmds);
+        co_await release_pooled(std::move(*pc), !replies);
+        if (!replies) {
+            if (replies.error().category == RedisErrorCategory::Io)
+                schedule_topology_refresh();
+            co_return replies;
+        }
 
-        std::string host;
-        std::uint16_t port;
-        {
-            auto g = co_await mutex_.lock();
-            auto idx = node_index_for_slot_locked(slot);
-            if (!idx) co_return std::unexpected(idx.error());
-            host = nodes_[static_cast<std::size_t>(*idx)]->cfg.host;
-            port = nodes_[static_cast<std::size_t>(*idx)]->cfg.port;
+        for (const auto &r: *replies) {
+            if (r || r.error().category != RedisErrorCategory::ServerReply)
+                continue;
+            auto redir = parse_redirection(r.error().message);
+            if (redir && redir->type == RedirType::Moved) {
+                co_await apply_moved(*redir);
+                note_moved();
+            }
         }
 
-        co_return co_await connect_to_node(host, port);
+        co_return replies;
     }
 
     task::Awaitable<RedisResult<RedisValue> >
-    RedisClusterClient::command(
+    RedisClusterClient::Impl::command(
         std::string_view cmd,
         std::span<const std::string_view> args) {
         auto init = co_await connect();
@@ -734,13 +1798,33 @@ namespace usub::uredis {
             key_copy.assign(args[0].begin(), args[0].end());
 
         bool did_soft_rediscover = false;
+        const bool route_read = !args.empty()
+                                && cfg_.read_preference != ReadPreference::Master
+                                && is_readonly_command(cmd);
 
         for (int attempt = 0; attempt < cfg_.max_redirections; ++attempt) {
+            if (auto known = co_await known_ask_target(key_copy)) {
+                auto direct = co_await execute_ask(*known, cmd, args);
+                if (direct)
+                    co_return direct;
+
+                auto redir = parse_redirection(direct.error().message);
+                if (!redir || redir->type != RedirType::Moved)
+                    co_return direct;
+
+                // migration finished or was rolled back
+                co_await apply_moved(*redir);
+                note_moved();
+                continue;
+            }
+
             PooledClient pc;
             for (;;) {
                 auto ac = args.empty()
-                              ? co_await acquire_for_any()
-                              : co_await acquire_for_key(key_copy);
+                              ? co_await acquire_for_any(true)
+                              : route_read
+                                    ? co_await acquire_for_read(key_copy, true)
+                                    : co_await acquire_for_key(key_copy, true);
 
                 if (ac) {
                     pc = std::move(*ac);
@@ -749,16 +1833,18 @@ namespace usub::uredis {
 
                 if (!did_soft_rediscover && is_slot_mapping_empty_error(ac.error())) {
                     did_soft_rediscover = true;
-                    auto rr = co_await rediscover_slots_serialized();
+                    auto rr = co_await refresh_topology();
                     if (!rr)
                         co_return std::unexpected(rr.error());
                     continue;
                 }
 
+                if (ac.error().category == RedisErrorCategory::Io)
+                    schedule_topology_refresh();
                 co_return std::unexpected(ac.error());
             }
 
-            auto resp = co_await pc.client->command(cmd, args);
+            auto resp = co_await execute_on(pc, cmd, args);
             if (resp) {
                 co_await release_pooled(std::move(pc), false);
                 co_return resp;
@@ -768,6 +1854,8 @@ namespace usub::uredis {
 
             if (err.category != RedisErrorCategory::ServerReply) {
                 co_await release_pooled(std::move(pc), true);
+                if (err.category == RedisErrorCategory::Io)
+                    schedule_topology_refresh();
                 co_return std::unexpected(err);
             }
 
@@ -781,10 +1869,12 @@ namespace usub::uredis {
 
             if (redir.type == RedirType::Moved) {
                 co_await apply_moved(redir);
+                note_moved();
                 continue;
             }
 
             if (redir.type == RedirType::Ask) {
+                co_await note_ask(redir, key_copy);
                 auto ask_resp = co_await execute_ask(redir, cmd, args);
                 if (ask_resp)
                     co_return ask_resp;
@@ -793,6 +1883,7 @@ namespace usub::uredis {
                 auto redir2 = parse_redirection(err2.message);
                 if (redir2 && redir2->type == RedirType::Moved) {
                     co_await apply_moved(*redir2);
+                    note_moved();
                     continue;
                 }
 
@@ -805,4 +1896,421 @@ namespace usub::uredis {
         co_return std::unexpected(
             RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: too many redirections"});
     }
+    struct RedisClusterClient::Impl::FanOut {
+        std::vector<std::shared_ptr<Node> > nodes;
+        IndexedNodeCallback fn;
+        std::vector<RedisNodeReply> replies;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> workers{0};
+        sync::AsyncEvent done{sync::Reset::Manual, false};
+    };
+
+    std::vector<std::shared_ptr<RedisClusterClient::Node> >
+    RedisClusterClient::Impl::nodes_for_scope_locked(NodeScope scope) const {
+        std::vector<int> masters;
+        for (int idx: slot_to_node_) {
+            if (idx < 0 || static_cast<std::size_t>(idx) >= nodes_.size())
+                continue;
+            if (std::find(masters.begin(), masters.end(), idx) == masters.end())
+                masters.push_back(idx);
+        }
+
+        std::vector<std::shared_ptr<Node> > out;
+        if (scope != NodeScope::Replicas) {
+            for (int m: masters)
+                out.push_back(nodes_[static_cast<std::size_t>(m)]);
+        }
+
+        if (scope != NodeScope::Masters) {
+            for (int m: masters) {
+                if (static_cast<std::size_t>(m) >= replicas_of_.size())
+                    continue;
+                for (int r: replicas_of_[static_cast<std::size_t>(m)]) {
+                    const auto &n = nodes_[static_cast<std::size_t>(r)];
+                    if (n->replica.load(std::memory_order_relaxed))
+                        out.push_back(n);
+                }
+            }
+        }
+
+        return out;
+    }
+
+    task::Awaitable<void> RedisClusterClient::Impl::fan_out_worker(std::shared_ptr<FanOut> st) {
+        for (;;) {
+            const auto i = st->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= st->nodes.size())
+                break;
+
+            auto pc = co_await acquire_from_node(st->nodes[i]);
+            if (!pc) {
+                if (pc.error().category == RedisErrorCategory::Io)
+                    schedule_topology_refresh();
+                st->replies[i].result = std::unexpected(pc.error());
+                continue;
+            }
+
+            auto r = co_await st->fn(i, *pc->client);
+            const bool faulty = !r && r.error().category != RedisErrorCategory::ServerReply;
+            co_await release_pooled(std::move(*pc), faulty);
+
+            st->replies[i].result = std::move(r);
+        }
+
+        if (st->workers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            st->done.set();
+    }
+
+    task::Awaitable<std::vector<RedisNodeReply> >
+    RedisClusterClient::Impl::fan_out(
+        std::vector<std::shared_ptr<Node> > nodes,
+        IndexedNodeCallback fn,
+        std::size_t max_concurrency) {
+        if (nodes.empty())
+            co_return std::vector<RedisNodeReply>{};
+
+        auto st = std::make_shared<FanOut>();
+        st->fn = std::move(fn);
+        st->replies.reserve(nodes.size());
+        for (const auto &n: nodes) {
+            st->replies.push_back(RedisNodeReply{
+                RedisClusterNode{n->cfg.host, n->cfg.port},
+                std::unexpected(RedisError{RedisErrorCategory::Io, "RedisClusterClient: node not visited"})
+            });
+        }
+        st->nodes = std::move(nodes);
+
+        std::size_t workers = st->nodes.size();
+        if (max_concurrency > 0 && max_concurrency < workers)
+            workers = max_concurrency;
+        st->workers.store(workers, std::memory_order_relaxed);
+
+        for (std::size_t w = 1; w < workers; ++w)
+            system::co_spawn(fan_out_worker(st));
+        co_await fan_out_worker(st);
+        co_await st->done.wait();
+
+        co_return std::move(st->replies);
+    }
+
+    RedisResult<void> RedisClusterClient::Impl::first_error(const std::vector<RedisNodeReply> &replies) {
+        for (const auto &r: replies) {
+            if (!r.result)
+                return std::unexpected(RedisError{
+                    r.result.error().category,
+                    r.node.host + ":" + std::to_string(r.node.port) + ": " + r.result.error().message
+                });
+        }
+        return {};
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::Impl::for_each_node(
+        NodeScope scope,
+        NodeCallback fn,
+        std::size_t max_concurrency) {
+        auto init = co_await connect();
+        if (!init) co_return std::unexpected(init.error());
+
+        std::vector<std::shared_ptr<Node> > nodes;
+        {
+            auto g = co_await mutex_.lock();
+            nodes = nodes_for_scope_locked(scope);
+        }
+
+        if (nodes.empty())
+            co_return std::unexpected(
+                RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: no nodes"});
+
+        std::vector<RedisClusterNode> addrs;
+        addrs.reserve(nodes.size());
+        for (const auto &n: nodes)
+            addrs.push_back(RedisClusterNode{n->cfg.host, n->cfg.port});
+
+        co_return co_await fan_out(
+            std::move(nodes),
+            [&addrs, &fn](std::size_t i, RedisClient &c) { return fn(addrs[i], c); },
+            max_concurrency);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::Impl::for_each_master(NodeCallback fn, std::size_t max_concurrency) {
+        co_return co_await for_each_node(NodeScope::Masters, std::move(fn), max_concurrency);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::Impl::broadcast(
+        std::string_view cmd,
+        std::span<const std::string_view> args,
+        NodeScope scope) {
+        co_return co_await for_each_node(
+            scope,
+            [cmd, args](const RedisClusterNode &, RedisClient &c) { return c.command(cmd, args); });
+    }
+
+    task::Awaitable<RedisResult<int64_t> > RedisClusterClient::Impl::dbsize() {
+        std::span<const std::string_view> no_args;
+        auto replies = co_await broadcast("DBSIZE", no_args);
+        if (!replies) co_return std::unexpected(replies.error());
+
+        auto err = first_error(*replies);
+        if (!err) co_return std::unexpected(err.error());
+
+        int64_t total = 0;
+        for (const auto &r: *replies) {
+            if (!r.result->is_integer())
+                co_return std::unexpected(
+                    RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: DBSIZE expected integer"});
+            total += r.result->as_integer();
+        }
+        co_return total;
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::Impl::flushall(bool async) {
+        std::array<std::string_view, 1> args{"ASYNC"};
+        auto replies = co_await broadcast(
+            "FLUSHALL",
+            std::span<const std::string_view>(args.data(), async ? 1 : 0));
+        if (!replies) co_return std::unexpected(replies.error());
+        co_return first_error(*replies);
+    }
+
+    task::Awaitable<RedisResult<std::vector<std::string> > >
+    RedisClusterClient::Impl::keys(std::string_view pattern) {
+        std::array<std::string_view, 1> args{pattern};
+        auto replies = co_await broadcast("KEYS", args);
+        if (!replies) co_return std::unexpected(replies.error());
+
+        auto err = first_error(*replies);
+        if (!err) co_return std::unexpected(err.error());
+
+        std::vector<std::string> out;
+        for (const auto &r: *replies) {
+            if (!r.result->is_array()) continue;
+            for (const auto &k: r.result->as_array()) {
+                if (k.is_bulk_string() || k.is_simple_string())
+                    out.push_back(k.as_string());
+            }
+        }
+        co_return out;
+    }
+
+    task::Awaitable<RedisResult<std::string> >
+    RedisClusterClient::Impl::script_load(std::string_view script) {
+        std::array<std::string_view, 2> args{"LOAD", script};
+        auto replies = co_await broadcast("SCRIPT", args, NodeScope::All);
+        if (!replies) co_return std::unexpected(replies.error());
+
+        auto err = first_error(*replies);
+        if (!err) co_return std::unexpected(err.error());
+
+        const auto &first = replies->front().result;
+        if (!first->is_bulk_string() && !first->is_simple_string())
+            co_return std::unexpected(
+                RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: SCRIPT LOAD expected string"});
+        co_return first->as_string();
+    }
+
+    task::Awaitable<RedisResult<std::vector<std::string> > >
+    RedisClusterClient::Impl::scan(RedisClusterScanCursor &cursor, const RedisClusterScanOptions &opt) {
+        auto init = co_await connect();
+        if (!init) co_return std::unexpected(init.error());
+
+        std::vector<std::size_t> pending;
+        std::vector<std::shared_ptr<Node> > nodes;
+        {
+            auto g = co_await mutex_.lock();
+
+            if (!cursor.started) {
+                cursor.started = true;
+                cursor.shards.clear();
+                for (const auto &n: nodes_for_scope_locked(NodeScope::Masters))
+                    cursor.shards.push_back({RedisClusterNode{n->cfg.host, n->cfg.port}, "0", false});
+            }
+
+            for (std::size_t i = 0; i < cursor.shards.size(); ++i) {
+                if (cursor.shards[i].done)
+                    continue;
+                if (opt.max_concurrency > 0 && pending.size() >= opt.max_concurrency)
+                    break;
+
+                const auto &addr = cursor.shards[i].node;
+                std::shared_ptr<Node> node;
+                for (const auto &n: nodes_) {
+                    if (n->cfg.host == addr.host && n->cfg.port == addr.port) {
+                        node = n;
+                        break;
+                    }
+                }
+                if (!node)
+                    node = nodes_[static_cast<std::size_t>(ensure_node_locked(addr.host, addr.port))];
+
+                pending.push_back(i);
+                nodes.push_back(std::move(node));
+            }
+        }
+
+        std::vector<std::string> out;
+        if (pending.empty())
+            co_return out;
+
+        const std::string count = opt.count > 0 ? std::to_string(opt.count) : std::string{};
+
+        auto replies = co_await fan_out(
+            std::move(nodes),
+            [&](std::size_t i, RedisClient &c) -> task::Awaitable<RedisResult<RedisValue> > {
+                std::vector<std::string_view> args;
+                args.reserve(7);
+                args.push_back(cursor.shards[pending[i]].cursor);
+                if (!opt.match.empty()) {
+                    args.push_back("MATCH");
+                    args.push_back(opt.match);
+                }
+                if (!count.empty()) {
+                    args.push_back("COUNT");
+                    args.push_back(count);
+                }
+                if (!opt.type.empty()) {
+                    args.push_back("TYPE");
+                    args.push_back(opt.type);
+                }
+                co_return co_await c.command("SCAN", std::span<const std::string_view>(args.data(), args.size()));
+            },
+            opt.max_concurrency);
+
+        auto err = first_error(replies);
+        if (!err) co_return std::unexpected(err.error());
+
+        for (std::size_t i = 0; i < replies.size(); ++i) {
+            const auto &v = *replies[i].result;
+            if (!v.is_array() || v.as_array().size() != 2
+                || !v.as_array()[0].is_bulk_string() || !v.as_array()[1].is_array())
+                co_return std::unexpected(
+                    RedisError{RedisErrorCategory::Protocol, "RedisClusterClient: unexpected SCAN reply"});
+
+            auto &shard = cursor.shards[pending[i]];
+            shard.cursor = v.as_array()[0].as_string();
+            shard.done = shard.cursor == "0";
+
+            for (const auto &k: v.as_array()[1].as_array()) {
+                if (k.is_bulk_string() || k.is_simple_string())
+                    out.push_back(k.as_string());
+            }
+        }
+
+        co_return out;
+    }
+
+    RedisClusterClient::RedisClusterClient(RedisClusterConfig cfg)
+        : impl_(std::make_shared<Impl>(std::move(cfg))) {
+    }
+
+    RedisClusterClient::~RedisClusterClient() {
+        impl_->shutdown();
+    }
+
+    task::Awaitable<void> RedisClusterClient::stop() {
+        return impl_->stop();
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::connect() {
+        return impl_->connect();
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::refresh_topology() {
+        return impl_->refresh_topology();
+    }
+
+    void RedisClusterClient::schedule_topology_refresh() {
+        impl_->schedule_topology_refresh();
+    }
+
+    task::Awaitable<RedisResult<RedisValue> > RedisClusterClient::command(
+        std::string_view cmd,
+        std::span<const std::string_view> args) {
+        return impl_->command(cmd, args);
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::get_client_for_key(std::string_view key) {
+        return impl_->get_client_for_key(key);
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::get_any_client() {
+        return impl_->get_any_client();
+    }
+
+    task::Awaitable<RedisResult<RedisClusterClient::ClientLease> >
+    RedisClusterClient::get_client_for_slot(int slot) {
+        return impl_->get_client_for_slot(slot);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeGroup> > >
+    RedisClusterClient::group_by_node(std::span<const std::string_view> keys) {
+        return impl_->group_by_node(keys);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisClusterClient::execute_on_node(
+        const RedisClusterNode &node,
+        std::span<const RedisCommandView> cmds) {
+        return impl_->execute_on_node(node, cmds);
+    }
+
+    task::Awaitable<RedisResult<RedisClusterNode> > RedisClusterClient::master_for_slot(int slot) {
+        return impl_->master_for_slot(slot);
+    }
+
+    RedisConfig RedisClusterClient::node_config(std::string_view host, std::uint16_t port) const {
+        return impl_->node_config(host, port);
+    }
+
+    const RedisClusterConfig &RedisClusterClient::config() const noexcept {
+        return impl_->config();
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::for_each_node(
+        NodeScope scope,
+        NodeCallback fn,
+        std::size_t max_concurrency) {
+        return impl_->for_each_node(scope, std::move(fn), max_concurrency);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::for_each_master(NodeCallback fn, std::size_t max_concurrency) {
+        return impl_->for_each_master(std::move(fn), max_concurrency);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisNodeReply> > >
+    RedisClusterClient::broadcast(
+        std::string_view cmd,
+        std::span<const std::string_view> args,
+        NodeScope scope) {
+        return impl_->broadcast(cmd, args, scope);
+    }
+
+    task::Awaitable<RedisResult<int64_t> > RedisClusterClient::dbsize() {
+        return impl_->dbsize();
+    }
+
+    task::Awaitable<RedisResult<void> > RedisClusterClient::flushall(bool async) {
+        return impl_->flushall(async);
+    }
+
+    task::Awaitable<RedisResult<std::vector<std::string> > >
+    RedisClusterClient::keys(std::string_view pattern) {
+        return impl_->keys(pattern);
+    }
+
+    task::Awaitable<RedisResult<std::string> >
+    RedisClusterClient::script_load(std::string_view script) {
+        return impl_->script_load(script);
+    }
+
+    task::Awaitable<RedisResult<std::vector<std::string> > >
+    RedisClusterClient::scan(RedisClusterScanCursor &cursor, const RedisClusterScanOptions &opt) {
+        return impl_->scan(cursor, opt);
+    }
 } // namespace usub::uredis
@@ -0,0 +1,352 @@
+#include "uredis/RedisClusterSubscriber.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    RedisClusterSubscriber::RedisClusterSubscriber(RedisClusterClient& cluster)
+        : cluster_(cluster)
+    {
+    }
+
+    RedisClusterSubscriber::~RedisClusterSubscriber()
+    {
+        this->bg_->stopping.store(true);
+    }
+
+    std::string RedisClusterSubscriber::node_key(const RedisClusterNode& node)
+    {
+        return node.host + ":" + std::to_string(node.port);
+    }
+
+    task::Awaitable<RedisResult<std::pair<std::string, std::shared_ptr<RedisSubscriber>>>>
+    RedisClusterSubscriber::connection_for_locked(const RedisClusterNode& node)
+    {
+        std::string key = node_key(node);
+
+        auto it = this->connections_.find(key);
+        if (it != this->connections_.end())
+        {
+            if (it->second.subscriber->is_connected())
+            {
+                co_return std::make_pair(key, it->second.subscriber);
+            }
+            // its close callback may not have run yet; once replaced it is ignored, so the
+            // channels it served are re-homed from here
+            if (co_await this->detach_locked(key, std::nullopt) > 0)
+                this->schedule_rehome();
+        }
+
+        auto sub = std::make_shared<RedisSubscriber>(this->cluster_.node_config(node.host, node.port));
+        auto c = co_await sub->connect();
+        if (!c)
+        {
+            // a failure after the socket connected (AUTH) leaves a reader behind
+            co_await sub->close();
+            this->prune_retired_locked();
+            if (sub->reader_running()) this->retired_.push_back(std::move(sub));
+            co_return std::unexpected(c.error());
+        }
+
+        auto bg = this->bg_;
+        std::weak_ptr<RedisSubscriber> weak = sub;
+        sub->set_sunsubscribe_callback([this, bg, key, weak](const std::string& channel)
+        {
+            if (!bg->enter()) return;
+            system::co_spawn(this->detach(key, weak, channel));
+        });
+        sub->set_close_callback([this, bg, key, weak]()
+        {
+            if (!bg->enter()) return;
+            system::co_spawn(this->detach(key, weak, std::nullopt));
+        });
+
+        this->connections_[key] = Connection{sub, 0};
+
+#ifdef UREDIS_LOGS
+        ulog::info("RedisClusterSubscriber: connected to {}", key);
+#endif
+        co_return std::make_pair(std::move(key), std::move(sub));
+    }
+
+    task::Awaitable<void> RedisClusterSubscriber::retire_locked(const std::string& key)
+    {
+        auto it = this->connections_.find(key);
+        if (it == this->connections_.end()) co_return;
+
+        auto sub = std::move(it->second.subscriber);
+        this->connections_.erase(it);
+
+        co_await sub->close();
+        this->prune_retired_locked();
+        // the reader may still be running, keep the object alive until it returns
+        if (sub->reader_running()) this->retired_.push_back(std::move(sub));
+    }
+
+    void RedisClusterSubscriber::prune_retired_locked()
+    {
+        std::erase_if(this->retired_, [](const std::shared_ptr<RedisSubscriber>& s)
+        {
+            return !s->reader_running();
+        });
+    }
+
+    task::Awaitable<RedisResult<void>> RedisClusterSubscriber::subscribe_locked(
+        const std::string& channel,
+        MessageCallback cb)
+    {
+        const int attempts = std::max(1, this->cluster_.config().max_redirections);
+        RedisError last_err{RedisErrorCategory::Io, "no attempts"};
+
+        for (int attempt = 0; attempt < attempts; ++attempt)
+        {
+            auto master = co_await this->cluster_.master_for_slot(static_cast<int>(slot_of(channel)));
+            if (!master)
+            {
+                co_return std::unexpected(master.error());
+            }
+
+            auto conn = co_await this->connection_for_locked(*master);
+            if (!conn)
+            {
+                last_err = conn.error();
+                (void) co_await this->cluster_.refresh_topology();
+                continue;
+            }
+
+            auto& [key, sub] = *conn;
+            auto r = co_await sub->ssubscribe(channel, cb);
+            if (r)
+            {
+                this->subscriptions_[channel] = Subscription{std::move(cb), key};
+                this->connections_[key].channels++;
+                co_return RedisResult<void>{};
+            }
+
+            last_err = r.error();
+            const bool moved = last_err.category == RedisErrorCategory::ServerReply
+                               && last_err.message.starts_with("MOVED");
+            if (!moved && last_err.category != RedisErrorCategory::Io)
+            {
+                co_return std::unexpected(last_err);
+            }
+
+            (void) co_await this->cluster_.refresh_topology();
+        }
+
+        co_return std::unexpected(last_err);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisClusterSubscriber::ssubscribe(std::string channel, MessageCallback cb)
+    {
+        auto g = co_await this->mutex_.lock();
+        if (this->closed_)
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisClusterSubscriber closed"});
+        }
+
+        auto it = this->subscriptions_.find(channel);
+        if (it != this->subscriptions_.end())
+        {
+            // already subscribed: only the callback changes
+            it->second.callback = cb;
+            auto conn = this->connections_.find(it->second.node_key);
+            if (conn != this->connections_.end())
+            {
+                co_return co_await conn->second.subscriber->ssubscribe(channel, std::move(cb));
+            }
+            co_return RedisResult<void>{};
+        }
+
+        co_return co_await this->subscribe_locked(channel, std::move(cb));
+    }
+
+    task::Awaitable<RedisResult<void>> RedisClusterSubscriber::sunsubscribe(std::string channel)
+    {
+        auto g = co_await this->mutex_.lock();
+
+        auto it = this->subscriptions_.find(channel);
+        if (it == this->subscriptions_.end())
+        {
+            co_return RedisResult<void>{};
+        }
+
+        const std::string key = it->second.node_key;
+        this->subscriptions_.erase(it);
+
+        auto conn = this->connections_.find(key);
+        if (conn == this->connections_.end())
+        {
+            co_return RedisResult<void>{};
+        }
+
+        auto sub = conn->second.subscriber;
+        auto r = co_await sub->sunsubscribe(channel);
+
+        if (conn->second.channels > 0 && --conn->second.channels == 0)
+        {
+            co_await this->retire_locked(key);
+        }
+
+        co_return r;
+    }
+
+    task::Awaitable<RedisResult<int64_t>> RedisClusterSubscriber::spublish(
+        std::string_view channel,
+        std::string_view payload)
+    {
+        auto r = co_await this->cluster_.command("SPUBLISH", channel, payload);
+        if (!r) co_return std::unexpected(r.error());
+        if (!r->is_integer())
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "SPUBLISH: unexpected type"});
+        }
+        co_return r->as_integer();
+    }
+
+    task::Awaitable<void> RedisClusterSubscriber::close()
+    {
+        {
+            auto g = co_await this->mutex_.lock();
+            this->closed_ = true;
+            this->bg_->stopping.store(true);
+
+            for (auto& [_, conn] : this->connections_)
+            {
+                co_await conn.subscriber->close();
+                this->retired_.push_back(std::move(conn.subscriber));
+            }
+            this->connections_.clear();
+            this->subscriptions_.clear();
+        }
+
+        if (this->bg_->running.load() > 0)
+            co_await this->bg_->idle.wait();
+
+        // nothing adds to retired_ any more; its readers return right after the shutdown
+        for (;;)
+        {
+            this->prune_retired_locked();
+            if (this->retired_.empty()) break;
+            co_await system::this_coroutine::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    task::Awaitable<std::size_t> RedisClusterSubscriber::detach_locked(
+        const std::string& key,
+        const std::optional<std::string>& channel)
+    {
+        std::size_t detached = 0;
+        for (auto& [name, sub] : this->subscriptions_)
+        {
+            if (sub.node_key != key) continue;
+            if (channel && name != *channel) continue;
+            sub.node_key.clear();
+            ++detached;
+        }
+
+        auto conn = this->connections_.find(key);
+        if (conn != this->connections_.end())
+        {
+            conn->second.channels -= std::min(conn->second.channels, detached);
+            if (!channel || conn->second.channels == 0)
+            {
+                co_await this->retire_locked(key);
+            }
+        }
+
+#ifdef UREDIS_LOGS
+        ulog::warn("RedisClusterSubscriber: {} channel(s) of {} lost their node, re-homing", detached, key);
+#endif
+        co_return detached;
+    }
+
+    task::Awaitable<void> RedisClusterSubscriber::detach(
+        std::string key,
+        std::weak_ptr<RedisSubscriber> origin,
+        std::optional<std::string> channel)
+    {
+        bool detached = false;
+        {
+            auto g = co_await this->mutex_.lock();
+
+            // a late event from a connection that was already replaced must not touch the new one
+            auto conn = this->connections_.find(key);
+            auto self = origin.lock();
+            if (!this->closed_ && conn != this->connections_.end() && self && conn->second.subscriber == self)
+                detached = co_await this->detach_locked(key, channel) > 0;
+        }
+
+        if (detached) this->schedule_rehome();
+        this->bg_->leave();
+    }
+
+    void RedisClusterSubscriber::schedule_rehome()
+    {
+        if (this->rehome_running_.exchange(true, std::memory_order_acq_rel)) return;
+        if (!this->bg_->enter())
+        {
+            this->rehome_running_.store(false, std::memory_order_release);
+            return;
+        }
+        system::co_spawn(this->rehome());
+    }
+
+    task::Awaitable<void> RedisClusterSubscriber::rehome()
+    {
+        auto bg = this->bg_;
+        auto backoff = std::chrono::milliseconds(100);
+
+        for (;;)
+        {
+            (void) co_await this->cluster_.refresh_topology();
+
+            bool failed = false;
+            {
+                auto g = co_await this->mutex_.lock();
+
+                // subscribing can replace a dead connection and detach more channels: repeat
+                while (!failed && !this->closed_)
+                {
+                    std::vector<std::pair<std::string, MessageCallback>> detached;
+                    for (const auto& [name, sub] : this->subscriptions_)
+                    {
+                        if (sub.node_key.empty()) detached.emplace_back(name, sub.callback);
+                    }
+                    if (detached.empty()) break;
+
+                    for (auto& [name, cb] : detached)
+                    {
+                        auto r = co_await this->subscribe_locked(name, std::move(cb));
+                        if (!r)
+                        {
+#ifdef UREDIS_LOGS
+                            ulog::warn("RedisClusterSubscriber: re-home of {} failed: {}", name, r.error().message);
+#endif
+                            failed = true;
+                        }
+                    }
+                }
+
+                if (!failed || this->closed_)
+                {
+                    this->rehome_running_.store(false, std::memory_order_release);
+                    break;
+                }
+            }
+
+            // no ticket while sleeping, so close() does not wait out the backoff
+            bg->leave();
+            co_await system::this_coroutine::sleep_for(backoff);
+            if (!bg->enter()) co_return;
+            backoff = std::min(backoff * 2, std::chrono::milliseconds(5000));
+        }
+
+        bg->leave();
+    }
+} // namespace usub::uredis
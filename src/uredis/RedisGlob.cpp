@@ -0,0 +1,215 @@
+#include "uredis/RedisGlob.h"
+
+#include <algorithm>
+
+namespace usub::uredis
+{
+    namespace
+    {
+        // Index of the `]` closing the class opened at pattern[open], or npos when there is
+        // none and the `[` is a literal.
+        std::size_t class_close(std::string_view pattern, std::size_t open) noexcept
+        {
+            if (pattern.find(']', open + 1) == std::string_view::npos) return std::string_view::npos;
+
+            std::size_t end = open + 1;
+            while (end < pattern.size() && pattern[end] != ']')
+            {
+                if (pattern[end] == '\\' && end + 1 < pattern.size()) ++end;
+                ++end;
+            }
+            return end < pattern.size() ? end : std::string_view::npos;
+        }
+
+        // Same reading of the class body as GlobTrie::compile_class, without building the set.
+        bool class_match(std::string_view spec, unsigned char c) noexcept
+        {
+            bool negate = false;
+            std::size_t i = 0;
+            if (!spec.empty() && spec[0] == '^')
+            {
+                negate = true;
+                i = 1;
+            }
+
+            bool hit = false;
+            for (; i < spec.size() && !hit; ++i)
+            {
+                if (spec[i] == '\\' && i + 1 < spec.size())
+                {
+                    hit = static_cast<unsigned char>(spec[++i]) == c;
+                }
+                else if (i + 2 < spec.size() && spec[i + 1] == '-')
+                {
+                    auto lo = static_cast<unsigned char>(spec[i]);
+                    auto hi = static_cast<unsigned char>(spec[i + 2]);
+                    if (lo > hi) std::swap(lo, hi);
+                    hit = c >= lo && c <= hi;
+                    i += 2;
+                }
+                else
+                {
+                    hit = static_cast<unsigned char>(spec[i]) == c;
+                }
+            }
+
+            return hit != negate;
+        }
+    }
+
+    bool glob_match(std::string_view pattern, std::string_view text) noexcept
+    {
+        // Greedy walk that only backtracks to the last `*`: whatever an earlier star would
+        // absorb, the last one can absorb as well.
+        constexpr auto none = std::string_view::npos;
+        std::size_t p = 0;
+        std::size_t t = 0;
+        std::size_t star_p = none;
+        std::size_t star_t = 0;
+
+        while (t < text.size())
+        {
+            if (p < pattern.size())
+            {
+                const char c = pattern[p];
+                if (c == '*')
+                {
+                    while (p + 1 < pattern.size() && pattern[p + 1] == '*') ++p;
+                    star_p = ++p;
+                    star_t = t;
+                    continue;
+                }
+
+                bool ok;
+                std::size_t next = p + 1;
+                std::size_t close;
+                if (c == '?')
+                {
+                    ok = true;
+                }
+                else if (c == '[' && (close = class_close(pattern, p)) != none)
+                {
+                    ok = class_match(pattern.substr(p + 1, close - p - 1), static_cast<unsigned char>(text[t]));
+                    next = close + 1;
+                }
+                else if (c == '\\' && p + 1 < pattern.size())
+                {
+                    ok = pattern[p + 1] == text[t];
+                    next = p + 2;
+                }
+                else
+                {
+                    ok = c == text[t];
+                }
+
+                if (ok)
+                {
+                    p = next;
+                    ++t;
+                    continue;
+                }
+            }
+
+            if (star_p == none) return false;
+            p = star_p;
+            t = ++star_t;
+        }
+
+        while (p < pattern.size() && pattern[p] == '*') ++p;
+        return p == pattern.size();
+    }
+
+    void GlobTrie::insert(std::string_view pattern, std::size_t value)
+    {
+        Node* node = &this->root_;
+
+        for (std::size_t i = 0; i < pattern.size(); ++i)
+        {
+            const char c = pattern[i];
+
+            if (c == '*')
+            {
+                while (i + 1 < pattern.size() && pattern[i + 1] == '*') ++i;
+                if (!node->star) node->star = std::make_unique<Node>();
+                node = node->star.get();
+            }
+            else if (c == '?')
+            {
+                if (!node->any) node->any = std::make_unique<Node>();
+                node = node->any.get();
+            }
+            else if (c == '[' && class_close(pattern, i) != std::string_view::npos)
+            {
+                const std::size_t end = class_close(pattern, i);
+                const std::string_view spec = pattern.substr(i + 1, end - i - 1);
+                i = end;
+
+                auto it = std::find_if(node->classes.begin(), node->classes.end(),
+                                       [spec](const CharClass& cc) { return cc.spec == spec; });
+                if (it == node->classes.end())
+                {
+                    node->classes.push_back(CharClass{std::string(spec), compile_class(spec),
+                                                      std::make_unique<Node>()});
+                    it = node->classes.end() - 1;
+                }
+                node = it->next.get();
+            }
+            else if (c == '\\' && i + 1 < pattern.size())
+            {
+                node = literal_child(*node, pattern[++i]);
+            }
+            else
+            {
+                node = literal_child(*node, c);
+            }
+        }
+
+        node->values.push_back(value);
+        this->empty_ = false;
+    }
+
+    GlobTrie::Node* GlobTrie::literal_child(Node& node, char c)
+    {
+        for (auto& [ch, next] : node.literals)
+        {
+            if (ch == c) return next.get();
+        }
+        node.literals.emplace_back(c, std::make_unique<Node>());
+        return node.literals.back().second.get();
+    }
+
+    std::bitset<256> GlobTrie::compile_class(std::string_view spec)
+    {
+        std::bitset<256> set;
+        bool negate = false;
+        std::size_t i = 0;
+        if (!spec.empty() && spec[0] == '^')
+        {
+            negate = true;
+            i = 1;
+        }
+
+        for (; i < spec.size(); ++i)
+        {
+            if (spec[i] == '\\' && i + 1 < spec.size())
+            {
+                set.set(static_cast<unsigned char>(spec[++i]));
+            }
+            else if (i + 2 < spec.size() && spec[i + 1] == '-')
+            {
+                auto lo = static_cast<unsigned char>(spec[i]);
+                auto hi = static_cast<unsigned char>(spec[i + 2]);
+                if (lo > hi) std::swap(lo, hi);
+                for (unsigned v = lo; v <= hi; ++v) set.set(v);
+                i += 2;
+            }
+            else
+            {
+                set.set(static_cast<unsigned char>(spec[i]));
+            }
+        }
+
+        if (negate) set.flip();
+        return set;
+    }
+} // namespace usub::uredis
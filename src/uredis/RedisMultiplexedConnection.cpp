@@ -0,0 +1,433 @@
+#include "uredis/RedisMultiplexedConnection.h"
+
+#include <algorithm>
+#include <bit>
+#include <string>
+#include <vector>
+
+#include "uvent/sync/AsyncEvent.h"
+#include "uvent/utils/buffer/DynamicBuffer.h"
+#include "uvent/utils/datastructures/queue/ConcurrentQueues.h"
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis {
+    using usub::uvent::utils::DynamicBuffer;
+
+    static constexpr std::size_t mux_max_read = 64 * 1024;
+
+    // Read deadline while no reply is owed: the connection only waits for the server then, and
+    // writing a request arms io_timeout_ms again.
+    static constexpr int mux_idle_timeout_ms = 24 * 60 * 60 * 1000;
+
+    struct RedisMultiplexedConnection::Pending {
+        sync::AsyncEvent event{sync::Reset::Manual, false};
+        RedisResult<RedisValue> result{
+            std::unexpected(RedisError{RedisErrorCategory::Protocol, "uninitialized"})
+        };
+    };
+
+    struct RedisMultiplexedConnection::State {
+        State(std::size_t max_inflight, int io_timeout)
+            : io_timeout_ms(io_timeout)
+            , pending(std::bit_ceil(max_inflight + 1)) {}
+
+        std::shared_ptr<net::TCPClientSocket> socket;
+        RespParser parser{};
+        int io_timeout_ms;
+
+        // guarded by write_mutex; requests are queued in the order their frames are appended
+        sync::AsyncMutex write_mutex;
+        std::vector<std::uint8_t> outbuf;
+        bool flushing{false};
+        bool open{false};
+
+        std::atomic<bool> alive{false};
+        usub::queue::concurrent::MPMCQueue<std::shared_ptr<Pending>> pending;
+        std::atomic<std::size_t> outstanding{0}; // entries in pending
+    };
+
+    static void append_command(
+        std::vector<std::uint8_t> &out,
+        std::string_view cmd,
+        std::span<const std::string_view> args) {
+        auto append_sv = [&out](std::string_view s) {
+            out.insert(out.end(),
+                       reinterpret_cast<const std::uint8_t *>(s.data()),
+                       reinterpret_cast<const std::uint8_t *>(s.data()) + s.size());
+        };
+
+        auto append_bulk = [&](std::string_view s) {
+            append_sv("$");
+            append_sv(std::to_string(s.size()));
+            append_sv("\r\n");
+            append_sv(s);
+            append_sv("\r\n");
+        };
+
+        append_sv("*");
+        append_sv(std::to_string(1 + args.size()));
+        append_sv("\r\n");
+
+        append_bulk(cmd);
+        for (auto a: args) append_bulk(a);
+    }
+
+    RedisMultiplexedConnection::RedisMultiplexedConnection(RedisConfig cfg, std::size_t max_inflight)
+        : config_(std::move(cfg))
+        , max_inflight_(max_inflight == 0 ? 1 : max_inflight)
+        , inflight_sem_(static_cast<int>(max_inflight_)) {
+        normalize_auth(config_.username);
+        normalize_auth(config_.password);
+    }
+
+    RedisMultiplexedConnection::~RedisMultiplexedConnection() {
+        close();
+    }
+
+    bool RedisMultiplexedConnection::connected() const noexcept {
+        auto st = state_.load(std::memory_order_acquire);
+        return st && st->alive.load(std::memory_order_acquire);
+    }
+
+    void RedisMultiplexedConnection::close() noexcept {
+        auto st = state_.exchange(nullptr, std::memory_order_acq_rel);
+        if (!st)
+            return;
+
+        // the reader wakes up on shutdown and fails whatever is still queued
+        st->alive.store(false, std::memory_order_release);
+        st->socket->shutdown();
+    }
+
+    task::Awaitable<RedisResult<void> > RedisMultiplexedConnection::connect() {
+        auto st = co_await open_state();
+        if (!st) co_return std::unexpected(st.error());
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<std::shared_ptr<RedisMultiplexedConnection::State> > >
+    RedisMultiplexedConnection::open_state() {
+        auto st = state_.load(std::memory_order_acquire);
+        if (st && st->alive.load(std::memory_order_acquire))
+            co_return st;
+
+        auto g = co_await connect_mutex_.lock();
+
+        st = state_.load(std::memory_order_acquire);
+        if (st && st->alive.load(std::memory_order_acquire))
+            co_return st;
+
+        auto fresh = std::make_shared<State>(max_inflight_, config_.io_timeout_ms);
+
+        auto sock = co_await RedisClient::open_socket(config_);
+        if (!sock) {
+#ifdef UREDIS_LOGS
+            ulog::error("RedisMultiplexedConnection::connect: {} endpoint=\"{}\"",
+                        sock.error().message, RedisClient::endpoint(config_));
+#endif
+            co_return std::unexpected(sock.error());
+        }
+        fresh->socket = std::move(*sock);
+
+        auto hs = co_await handshake(*fresh, config_);
+        if (!hs) {
+            fresh->socket->shutdown();
+            co_return std::unexpected(hs.error());
+        }
+
+        fresh->open = true;
+        fresh->alive.store(true, std::memory_order_release);
+        state_.store(fresh, std::memory_order_release);
+
+        system::co_spawn(reader_loop(fresh));
+
+#ifdef UREDIS_LOGS
+        ulog::info("RedisMultiplexedConnection::connect: OK endpoint=\"{}\"", RedisClient::endpoint(config_));
+#endif
+        co_return fresh;
+    }
+
+    task::Awaitable<RedisResult<RedisValue> > RedisMultiplexedConnection::handshake_command(
+        State &st,
+        const RedisConfig &cfg,
+        std::string_view cmd,
+        std::span<const std::string_view> args) {
+        std::vector<std::uint8_t> frame;
+        append_command(frame, cmd, args);
+
+        std::size_t off = 0;
+        while (off < frame.size()) {
+            st.socket->update_timeout(cfg.io_timeout_ms);
+            const ssize_t n = co_await st.socket->async_write(frame.data() + off, frame.size() - off);
+            if (n <= 0)
+                co_return std::unexpected(RedisError{RedisErrorCategory::Io, "write failed"});
+            off += static_cast<std::size_t>(n);
+        }
+
+        DynamicBuffer buf;
+        buf.reserve(mux_max_read);
+
+        for (;;) {
+            if (auto v = st.parser.next()) {
+                if (v->type == RedisType::Error)
+                    co_return std::unexpected(RedisError{RedisErrorCategory::ServerReply, v->as_string()});
+                co_return std::move(*v);
+            }
+
+            buf.clear();
+            st.socket->update_timeout(cfg.io_timeout_ms);
+            const ssize_t rdsz = co_await st.socket->async_read(buf, mux_max_read);
+            if (rdsz <= 0)
+                co_return std::unexpected(RedisError{RedisErrorCategory::Io, "connection closed"});
+
+            st.parser.feed(reinterpret_cast<const std::uint8_t *>(buf.data()), static_cast<std::size_t>(rdsz));
+        }
+    }
+
+    task::Awaitable<RedisResult<void> > RedisMultiplexedConnection::handshake(State &st, const RedisConfig &cfg) {
+        if (cfg.password.has_value()) {
+            std::string_view args_arr[2];
+            std::size_t n = 0;
+            if (cfg.username.has_value())
+                args_arr[n++] = *cfg.username;
+            args_arr[n++] = *cfg.password;
+
+            auto r = co_await handshake_command(st, cfg, "AUTH", std::span<const std::string_view>(args_arr, n));
+            if (!r) co_return std::unexpected(r.error());
+        }
+
+        if (cfg.db != 0) {
+            std::string db = std::to_string(cfg.db);
+            std::string_view args_arr[1] = {db};
+
+            auto r = co_await handshake_command(st, cfg, "SELECT", std::span<const std::string_view>(args_arr, 1));
+            if (!r) co_return std::unexpected(r.error());
+        }
+
+        if (cfg.readonly) {
+            auto r = co_await handshake_command(st, cfg, "READONLY", std::span<const std::string_view>{});
+            if (!r) co_return std::unexpected(r.error());
+        }
+
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<RedisValue> > RedisMultiplexedConnection::command(
+        std::string_view cmd,
+        std::span<const std::string_view> args) {
+        const RedisCommandView one{cmd, args};
+        auto r = co_await submit(std::span<const RedisCommandView>(&one, 1));
+        if (!r) co_return std::unexpected(r.error());
+        co_return std::move(r->front());
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisMultiplexedConnection::pipeline(std::span<const RedisCommandView> cmds) {
+        if (cmds.empty())
+            co_return std::vector<RedisResult<RedisValue> >{};
+        if (cmds.size() > max_inflight_)
+            co_return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol, "RedisMultiplexedConnection: pipeline exceeds max in-flight"
+            });
+        co_return co_await submit(cmds);
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisMultiplexedConnection::pipeline_chunked(std::span<const RedisCommandView> cmds) {
+        if (cmds.size() <= max_inflight_)
+            co_return co_await pipeline(cmds);
+
+        std::vector<RedisResult<RedisValue> > out;
+        out.reserve(cmds.size());
+        for (std::size_t i = 0; i < cmds.size(); i += max_inflight_) {
+            auto part = co_await submit(cmds.subspan(i, std::min(max_inflight_, cmds.size() - i)));
+            if (!part) co_return std::unexpected(part.error());
+            for (auto &r: *part) out.push_back(std::move(r));
+        }
+        co_return out;
+    }
+
+    task::Awaitable<RedisResult<std::vector<RedisResult<RedisValue> > > >
+    RedisMultiplexedConnection::submit(std::span<const RedisCommandView> cmds) {
+        const std::size_t n = cmds.size();
+
+        if (n == 1) {
+            co_await inflight_sem_.acquire();
+        } else {
+            // one multi-slot acquirer at a time, so partial acquisitions cannot deadlock
+            auto g = co_await multi_acquire_mutex_.lock();
+            for (std::size_t i = 0; i < n; ++i)
+                co_await inflight_sem_.acquire();
+        }
+        inflight_.fetch_add(n, std::memory_order_relaxed);
+
+        std::vector<std::shared_ptr<Pending> > pending;
+        pending.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            pending.push_back(std::make_shared<Pending>());
+
+        std::optional<RedisError> err;
+
+        // retry only when the connection closed before the requests were queued, i.e. never sent
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            auto st = co_await open_state();
+            if (!st) {
+                err = st.error();
+                break;
+            }
+
+            std::size_t queued = 0;
+            bool start_flush = false;
+            {
+                auto g = co_await (*st)->write_mutex.lock();
+                if ((*st)->open) {
+                    while (queued < n && (*st)->pending.try_enqueue(pending[queued]))
+                        ++queued;
+                    (*st)->outstanding.fetch_add(queued);
+
+                    for (std::size_t i = 0; i < queued; ++i)
+                        append_command((*st)->outbuf, cmds[i].cmd, cmds[i].args);
+
+                    if (queued > 0 && !(*st)->flushing) {
+                        (*st)->flushing = true;
+                        start_flush = true;
+                    }
+                }
+            }
+
+            if (queued == 0) {
+                err = RedisError{RedisErrorCategory::Io, "connection closed"};
+                continue;
+            }
+
+            err.reset();
+            if (start_flush)
+                co_await flush(*st);
+            for (std::size_t i = 0; i < queued; ++i)
+                co_await pending[i]->event.wait();
+            for (std::size_t i = queued; i < n; ++i)
+                pending[i]->result = std::unexpected(RedisError{
+                    RedisErrorCategory::Protocol, "RedisMultiplexedConnection: request queue full"
+                });
+            break;
+        }
+
+        inflight_.fetch_sub(n, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < n; ++i)
+            inflight_sem_.release();
+
+        if (err)
+            co_return std::unexpected(*err);
+
+        std::vector<RedisResult<RedisValue> > out;
+        out.reserve(n);
+        for (auto &p: pending)
+            out.push_back(std::move(p->result));
+        co_return out;
+    }
+
+    task::Awaitable<void> RedisMultiplexedConnection::flush(std::shared_ptr<State> st) {
+        std::vector<std::uint8_t> out;
+
+        for (;;) {
+            {
+                auto g = co_await st->write_mutex.lock();
+                if (st->outbuf.empty() || !st->open) {
+                    st->flushing = false;
+                    co_return;
+                }
+                out.clear();
+                out.swap(st->outbuf);
+            }
+
+            std::size_t off = 0;
+            while (off < out.size()) {
+                st->socket->update_timeout(st->io_timeout_ms);
+                const ssize_t n = co_await st->socket->async_write(out.data() + off, out.size() - off);
+                if (n <= 0) {
+#ifdef UREDIS_LOGS
+                    ulog::warn("RedisMultiplexedConnection::flush: write failed n={}", n);
+#endif
+                    co_await shutdown_state(st, "write failed");
+                    co_return;
+                }
+                off += static_cast<std::size_t>(n);
+            }
+        }
+    }
+
+    task::Awaitable<void> RedisMultiplexedConnection::shutdown_state(
+        std::shared_ptr<State> st,
+        std::string_view reason) {
+        {
+            auto g = co_await st->write_mutex.lock();
+            st->open = false;
+            st->flushing = false;
+            st->outbuf.clear();
+        }
+
+        st->alive.store(false, std::memory_order_release);
+        st->socket->shutdown();
+
+#ifdef UREDIS_LOGS
+        ulog::info("RedisMultiplexedConnection: closed: {}", reason);
+#else
+        (void) reason;
+#endif
+    }
+
+    task::Awaitable<void> RedisMultiplexedConnection::reader_loop(std::shared_ptr<State> st) {
+        DynamicBuffer buf;
+        buf.reserve(mux_max_read);
+
+        bool desync = false;
+        while (!desync) {
+            buf.clear();
+            // io_timeout_ms only bounds the wait for owed replies. Idle, re-check after arming:
+            // a request queued meanwhile may have armed io_timeout_ms before we overwrote it.
+            if (st->outstanding.load() == 0) {
+                st->socket->update_timeout(mux_idle_timeout_ms);
+                if (st->outstanding.load() > 0)
+                    st->socket->update_timeout(st->io_timeout_ms);
+            } else {
+                st->socket->update_timeout(st->io_timeout_ms);
+            }
+            const ssize_t rdsz = co_await st->socket->async_read(buf, mux_max_read);
+            if (rdsz <= 0)
+                break;
+
+            st->parser.feed(reinterpret_cast<const std::uint8_t *>(buf.data()), static_cast<std::size_t>(rdsz));
+
+            while (auto v = st->parser.next()) {
+                std::shared_ptr<Pending> p;
+                if (!st->pending.try_dequeue(p) || !p) {
+#ifdef UREDIS_LOGS
+                    ulog::error("RedisMultiplexedConnection::reader_loop: reply without pending request");
+#endif
+                    desync = true;
+                    break;
+                }
+                st->outstanding.fetch_sub(1);
+
+                if (v->type == RedisType::Error)
+                    p->result = std::unexpected(RedisError{RedisErrorCategory::ServerReply, v->as_string()});
+                else
+                    p->result = std::move(*v);
+                p->event.set();
+            }
+        }
+
+        co_await shutdown_state(st, desync ? "protocol desync" : "connection closed");
+
+        // open is false now, so nothing can be queued behind this drain
+        std::shared_ptr<Pending> p;
+        while (st->pending.try_dequeue(p)) {
+            if (!p) continue;
+            p->result = std::unexpected(RedisError{RedisErrorCategory::Io, "connection closed"});
+            p->event.set();
+        }
+    }
+} // namespace usub::uredis
@@ -17,6 +17,7 @@ namespace usub::uredis
             RedisConfig rc;
             rc.host = this->cfg_.host;
             rc.port = this->cfg_.port;
+            rc.unix_path = this->cfg_.unix_path;
             rc.db = this->cfg_.db;
             rc.username = this->cfg_.username;
             rc.password = this->cfg_.password;
@@ -13,6 +13,16 @@ namespace usub::uredis
     using Clock      = std::chrono::steady_clock;
     using Millis     = std::chrono::milliseconds;
 
+    const RedisScript& RedisRedlock::unlock_script()
+    {
+        static const RedisScript script{
+            "if redis.call('GET', KEYS[1]) == ARGV[1] then "
+            "return redis.call('DEL', KEYS[1]) "
+            "else return 0 end"
+        };
+        return script;
+    }
+
     std::string RedisRedlock::generate_random_value()
     {
         std::random_device rd;
@@ -79,6 +89,18 @@ namespace usub::uredis
 #endif
                 co_return std::unexpected(res.error());
             }
+
+            // best effort: a node that lost it reloads on NOSCRIPT at unlock time
+            auto loaded = co_await unlock_script().load(*c);
+#ifdef UREDIS_LOGS
+            if (!loaded)
+            {
+                usub::ulog::warn(
+                    "RedisRedlock::connect_all: SCRIPT LOAD failed: {}",
+                    loaded.error().message);
+            }
+#endif
+            (void)loaded;
         }
 
 #ifdef UREDIS_LOGS
@@ -91,29 +113,14 @@ namespace usub::uredis
         std::string_view resource,
         std::string_view value)
     {
-        static const std::string script =
-            "if redis.call('GET', KEYS[1]) == ARGV[1] then "
-            "return redis.call('DEL', KEYS[1]) "
-            "else return 0 end";
+        const std::string_view keys[1] = {resource};
+        const std::string_view args[1] = {value};
 
         for (auto& client : this->clients_)
         {
             if (!client) continue;
 
-            std::string res_key(resource);
-            std::string val_str(value);
-            std::string num_keys = "1";
-
-            std::array<std::string_view, 4> args{
-                std::string_view{script},
-                std::string_view{num_keys},
-                std::string_view{res_key},
-                std::string_view{val_str}
-            };
-
-            auto resp = co_await client->command(
-                "EVAL",
-                std::span<const std::string_view>(args.data(), args.size()));
+            auto resp = co_await unlock_script().eval(*client, keys, args);
 
             (void)resp;
 
@@ -122,8 +129,8 @@ namespace usub::uredis
             {
                 const auto& err = resp.error();
                 usub::ulog::warn(
-                    "RedisRedlock::unlock_all_nodes: EVAL failed for key='{}': {}",
-                    res_key,
+                    "RedisRedlock::unlock_all_nodes: EVALSHA failed for key='{}': {}",
+                    resource,
                     err.message);
             }
 #endif
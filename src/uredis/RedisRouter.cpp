@@ -0,0 +1,172 @@
+#include "uredis/RedisRouter.h"
+
+#include <algorithm>
+
+#include "uredis/RedisGlob.h"
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    struct RedisRouter::PatternSnapshot
+    {
+        GlobTrie trie;
+        std::vector<Handler> handlers; // indexed by the trie values
+    };
+
+    RedisRouter::RedisRouter(std::shared_ptr<RedisSubscriber> subscriber)
+        : subscriber_(std::move(subscriber))
+    {
+    }
+
+    bool RedisRouter::glob_match(std::string_view pattern, std::string_view text)
+    {
+        return usub::uredis::glob_match(pattern, text);
+    }
+
+    void RedisRouter::rebuild(PatternRoute& route)
+    {
+        auto snap = std::make_shared<PatternSnapshot>();
+        snap->handlers.reserve(route.locals.size());
+        for (const auto& [_, local] : route.locals)
+        {
+            snap->trie.insert(local.first, snap->handlers.size());
+            snap->handlers.push_back(local.second);
+        }
+        route.snapshot.store(std::move(snap), std::memory_order_release);
+    }
+
+    task::Awaitable<RedisResult<RedisRouter::HandlerId>> RedisRouter::on_channel(std::string channel, Handler handler)
+    {
+        auto g = co_await this->mutex_.lock();
+
+        const HandlerId id = ++this->next_id_;
+
+        auto& route = this->channels_[channel];
+        const bool first = !route;
+        if (first)
+        {
+            route = std::make_shared<ChannelRoute>();
+            route->handlers.store(std::make_shared<const std::vector<std::pair<HandlerId, Handler>>>());
+        }
+
+        auto cur = route->handlers.load(std::memory_order_acquire);
+        auto next = std::make_shared<std::vector<std::pair<HandlerId, Handler>>>(*cur);
+        next->emplace_back(id, std::move(handler));
+        route->handlers.store(std::move(next), std::memory_order_release);
+
+        if (first)
+        {
+            auto r = co_await this->subscriber_->subscribe_view(
+                channel,
+                [route = route](std::string_view ch, std::string_view payload)
+                {
+                    auto hs = route->handlers.load(std::memory_order_acquire);
+                    for (const auto& [_, h] : *hs) h(ch, payload);
+                });
+            if (!r)
+            {
+                this->channels_.erase(channel);
+                co_return std::unexpected(r.error());
+            }
+        }
+
+        this->entries_[id] = Entry{false, std::move(channel)};
+        co_return id;
+    }
+
+    task::Awaitable<RedisResult<RedisRouter::HandlerId>> RedisRouter::on_pattern(std::string pattern,
+                                                                                Handler handler,
+                                                                                std::string upstream)
+    {
+        if (upstream.empty()) upstream = pattern;
+
+        auto g = co_await this->mutex_.lock();
+
+        const HandlerId id = ++this->next_id_;
+
+        auto& route = this->patterns_[upstream];
+        const bool first = !route;
+        if (first) route = std::make_shared<PatternRoute>();
+
+        route->locals.emplace(id, std::make_pair(std::move(pattern), std::move(handler)));
+        rebuild(*route);
+
+        if (first)
+        {
+            auto r = co_await this->subscriber_->psubscribe_view(
+                upstream,
+                [route = route](std::string_view ch, std::string_view payload)
+                {
+                    auto snap = route->snapshot.load(std::memory_order_acquire);
+
+                    std::vector<std::size_t> hits;
+                    snap->trie.match(ch, [&hits](std::size_t v) { hits.push_back(v); });
+                    if (hits.size() > 1)
+                    {
+                        // one delivery per handler even if several trie paths match
+                        std::sort(hits.begin(), hits.end());
+                        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+                    }
+                    for (auto v : hits) snap->handlers[v](ch, payload);
+                });
+            if (!r)
+            {
+                this->patterns_.erase(upstream);
+                co_return std::unexpected(r.error());
+            }
+        }
+
+        this->entries_[id] = Entry{true, std::move(upstream)};
+        co_return id;
+    }
+
+    task::Awaitable<RedisResult<void>> RedisRouter::remove(HandlerId id)
+    {
+        auto g = co_await this->mutex_.lock();
+
+        auto e = this->entries_.find(id);
+        if (e == this->entries_.end())
+        {
+            co_return RedisResult<void>{};
+        }
+        const Entry entry = std::move(e->second);
+        this->entries_.erase(e);
+
+        if (!entry.pattern)
+        {
+            auto it = this->channels_.find(entry.key);
+            if (it == this->channels_.end()) co_return RedisResult<void>{};
+
+            auto& route = *it->second;
+            auto next = std::make_shared<std::vector<std::pair<HandlerId, Handler>>>(
+                *route.handlers.load(std::memory_order_acquire));
+            std::erase_if(*next, [id](const auto& h) { return h.first == id; });
+
+            if (!next->empty())
+            {
+                route.handlers.store(std::move(next), std::memory_order_release);
+                co_return RedisResult<void>{};
+            }
+
+            this->channels_.erase(it);
+            co_return co_await this->subscriber_->unsubscribe(entry.key);
+        }
+
+        auto it = this->patterns_.find(entry.key);
+        if (it == this->patterns_.end()) co_return RedisResult<void>{};
+
+        auto& route = *it->second;
+        route.locals.erase(id);
+        if (!route.locals.empty())
+        {
+            rebuild(route);
+            co_return RedisResult<void>{};
+        }
+
+        this->patterns_.erase(it);
+        co_return co_await this->subscriber_->punsubscribe(entry.key);
+    }
+} // namespace usub::uredis
@@ -0,0 +1,171 @@
+#include "uredis/RedisScan.h"
+
+#include <atomic>
+#include <vector>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    struct RedisScanIterator::State
+    {
+        Command command;
+        std::string cmd;
+        std::string key; // empty for SCAN
+        RedisScanOptions opt;
+        std::string count;
+
+        std::string cursor{"0"};
+
+        std::shared_ptr<RedisClusterClient> cluster;
+        RedisClusterScanCursor cluster_cursor;
+
+        // done is written by the fetch coroutine, which may run on another thread; in_flight only
+        // by the caller. ready is handed over through event.
+        std::atomic<bool> done{false};
+        std::atomic<bool> in_flight{false};
+        std::optional<RedisResult<RedisScanPage>> ready;
+        sync::AsyncEvent event{sync::Reset::Manual, false};
+    };
+
+    RedisScanIterator::RedisScanIterator(Command command, std::string_view cmd, std::string key, RedisScanOptions opt)
+        : st_(std::make_shared<State>())
+    {
+        this->st_->command = std::move(command);
+        this->st_->cmd = std::string(cmd);
+        this->st_->key = std::move(key);
+        this->st_->opt = std::move(opt);
+        if (this->st_->opt.count > 0)
+            this->st_->count = std::to_string(this->st_->opt.count);
+    }
+
+    RedisScanIterator RedisScanIterator::scan(std::shared_ptr<RedisClusterClient> cluster, RedisScanOptions opt)
+    {
+        RedisScanIterator it({}, "SCAN", {}, std::move(opt));
+        it.st_->cluster = std::move(cluster);
+        return it;
+    }
+
+    bool RedisScanIterator::done() const noexcept
+    {
+        // no fetch in flight means no writer, and ready was consumed before in_flight dropped
+        return !this->st_->in_flight.load(std::memory_order_acquire)
+            && this->st_->done.load(std::memory_order_acquire);
+    }
+
+    void RedisScanIterator::start_fetch(const std::shared_ptr<State>& st)
+    {
+        st->in_flight.store(true, std::memory_order_release);
+        st->event.reset();
+        system::co_spawn(fetch(st));
+    }
+
+    task::Awaitable<void> RedisScanIterator::fetch(std::shared_ptr<State> st)
+    {
+        // the state is owned here too, so an iterator dropped mid-prefetch is fine
+        auto r = st->cluster ? co_await fetch_cluster(*st) : co_await fetch_cursor(*st);
+        st->ready = std::move(r);
+        st->event.set();
+    }
+
+    task::Awaitable<RedisResult<RedisScanPage>> RedisScanIterator::fetch_cursor(State& st)
+    {
+        std::vector<std::string_view> args;
+        args.reserve(8);
+        if (!st.key.empty())
+            args.push_back(st.key);
+        args.push_back(st.cursor);
+        if (!st.opt.match.empty())
+        {
+            args.push_back("MATCH");
+            args.push_back(st.opt.match);
+        }
+        if (!st.count.empty())
+        {
+            args.push_back("COUNT");
+            args.push_back(st.count);
+        }
+        if (!st.opt.type.empty() && st.key.empty())
+        {
+            args.push_back("TYPE");
+            args.push_back(st.opt.type);
+        }
+
+        auto resp = co_await st.command(st.cmd, args);
+        if (!resp) co_return std::unexpected(resp.error());
+
+        const auto& v = *resp;
+        if (!v.is_array() || v.as_array().size() != 2
+            || !v.as_array()[0].is_bulk_string() || !v.as_array()[1].is_array())
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, st.cmd + ": unexpected reply"});
+        }
+
+        // advance only on success, so a failed page is asked for again
+        st.cursor = v.as_array()[0].as_string();
+        st.done.store(st.cursor == "0", std::memory_order_release);
+
+        RedisScanPage page;
+        page.reply = std::move(*resp);
+        page.items = std::span<const RedisValue>(page.reply.as_array()[1].as_array());
+        co_return page;
+    }
+
+    task::Awaitable<RedisResult<RedisScanPage>> RedisScanIterator::fetch_cluster(State& st)
+    {
+        RedisClusterScanOptions copt;
+        copt.match = st.opt.match;
+        copt.count = st.opt.count;
+        copt.type = st.opt.type;
+
+        auto keys = co_await st.cluster->scan(st.cluster_cursor, copt);
+        if (!keys) co_return std::unexpected(keys.error());
+        st.done.store(st.cluster_cursor.done(), std::memory_order_release);
+
+        RedisValue::Array arr;
+        arr.reserve(keys->size());
+        for (auto& k : *keys)
+            arr.push_back(RedisValue{RedisType::BulkString, std::move(k)});
+
+        RedisScanPage page;
+        page.reply = RedisValue{RedisType::Array, std::move(arr)};
+        page.items = std::span<const RedisValue>(page.reply.as_array());
+        co_return page;
+    }
+
+    task::Awaitable<std::optional<RedisResult<RedisScanPage>>> RedisScanIterator::next()
+    {
+        auto st = this->st_;
+
+        for (;;)
+        {
+            if (!st->in_flight.load(std::memory_order_acquire))
+            {
+                if (st->done.load(std::memory_order_acquire)) co_return std::nullopt;
+                start_fetch(st);
+            }
+
+            co_await st->event.wait();
+
+            auto r = std::move(*st->ready);
+            st->ready.reset();
+            st->in_flight.store(false, std::memory_order_release);
+
+            if (!r)
+            {
+#ifdef UREDIS_LOGS
+                usub::ulog::warn("RedisScanIterator::next: {} failed: {}", st->cmd, r.error().message);
+#endif
+                co_return std::optional<RedisResult<RedisScanPage>>{std::move(r)};
+            }
+
+            if (!st->done.load(std::memory_order_acquire) && st->opt.prefetch)
+                start_fetch(st);
+
+            if (r->empty()) continue;
+            co_return std::optional<RedisResult<RedisScanPage>>{std::move(r)};
+        }
+    }
+} // namespace usub::uredis
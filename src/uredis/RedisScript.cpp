@@ -0,0 +1,225 @@
+#include "uredis/RedisScript.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "uredis/RedisClusterClient.h"
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    namespace
+    {
+        // FIPS 180-4 SHA-1; only used to name scripts, so speed and side channels do not matter.
+        class Sha1
+        {
+        public:
+            void update(std::string_view data)
+            {
+                for (unsigned char c : data)
+                {
+                    this->block_[this->used_++] = c;
+                    if (this->used_ == 64)
+                    {
+                        this->compress();
+                        this->used_ = 0;
+                    }
+                }
+                this->length_ += data.size();
+            }
+
+            std::array<std::uint8_t, 20> finish()
+            {
+                const std::uint64_t bits = this->length_ * 8;
+
+                this->block_[this->used_++] = 0x80;
+                if (this->used_ > 56)
+                {
+                    while (this->used_ < 64) this->block_[this->used_++] = 0;
+                    this->compress();
+                    this->used_ = 0;
+                }
+                while (this->used_ < 56) this->block_[this->used_++] = 0;
+                for (int i = 7; i >= 0; --i)
+                    this->block_[this->used_++] = static_cast<std::uint8_t>(bits >> (i * 8));
+                this->compress();
+
+                std::array<std::uint8_t, 20> out{};
+                for (int i = 0; i < 5; ++i)
+                {
+                    out[i * 4] = static_cast<std::uint8_t>(this->h_[i] >> 24);
+                    out[i * 4 + 1] = static_cast<std::uint8_t>(this->h_[i] >> 16);
+                    out[i * 4 + 2] = static_cast<std::uint8_t>(this->h_[i] >> 8);
+                    out[i * 4 + 3] = static_cast<std::uint8_t>(this->h_[i]);
+                }
+                return out;
+            }
+
+        private:
+            std::uint32_t h_[5]{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            std::uint8_t block_[64]{};
+            std::size_t used_{0};
+            std::uint64_t length_{0};
+
+            static std::uint32_t rol(std::uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+            void compress()
+            {
+                std::uint32_t w[80];
+                for (int i = 0; i < 16; ++i)
+                {
+                    w[i] = static_cast<std::uint32_t>(this->block_[i * 4]) << 24
+                           | static_cast<std::uint32_t>(this->block_[i * 4 + 1]) << 16
+                           | static_cast<std::uint32_t>(this->block_[i * 4 + 2]) << 8
+                           | static_cast<std::uint32_t>(this->block_[i * 4 + 3]);
+                }
+                for (int i = 16; i < 80; ++i)
+                    w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+                std::uint32_t a = this->h_[0], b = this->h_[1], c = this->h_[2], d = this->h_[3], e = this->h_[4];
+                for (int i = 0; i < 80; ++i)
+                {
+                    std::uint32_t f, k;
+                    if (i < 20)
+                    {
+                        f = (b & c) | (~b & d);
+                        k = 0x5A827999;
+                    }
+                    else if (i < 40)
+                    {
+                        f = b ^ c ^ d;
+                        k = 0x6ED9EBA1;
+                    }
+                    else if (i < 60)
+                    {
+                        f = (b & c) | (b & d) | (c & d);
+                        k = 0x8F1BBCDC;
+                    }
+                    else
+                    {
+                        f = b ^ c ^ d;
+                        k = 0xCA62C1D6;
+                    }
+
+                    const std::uint32_t t = rol(a, 5) + f + e + k + w[i];
+                    e = d;
+                    d = c;
+                    c = rol(b, 30);
+                    b = a;
+                    a = t;
+                }
+
+                this->h_[0] += a;
+                this->h_[1] += b;
+                this->h_[2] += c;
+                this->h_[3] += d;
+                this->h_[4] += e;
+            }
+        };
+    }
+
+    RedisScript::RedisScript(std::string source)
+        : source_(std::move(source))
+          , sha1_(sha1_hex(this->source_))
+    {
+    }
+
+    std::string RedisScript::sha1_hex(std::string_view data)
+    {
+        Sha1 h;
+        h.update(data);
+        const auto digest = h.finish();
+
+        static constexpr char hex[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(40);
+        for (auto b : digest)
+        {
+            out.push_back(hex[b >> 4]);
+            out.push_back(hex[b & 0x0F]);
+        }
+        return out;
+    }
+
+    bool RedisScript::is_noscript(const RedisError& err) noexcept
+    {
+        return err.category == RedisErrorCategory::ServerReply && err.message.starts_with("NOSCRIPT");
+    }
+
+    std::vector<std::string_view> RedisScript::evalsha_args(
+        std::string_view numkeys,
+        std::span<const std::string_view> keys,
+        std::span<const std::string_view> args) const
+    {
+        std::vector<std::string_view> out;
+        out.reserve(2 + keys.size() + args.size());
+        out.push_back(this->sha1_);
+        out.push_back(numkeys);
+        out.insert(out.end(), keys.begin(), keys.end());
+        out.insert(out.end(), args.begin(), args.end());
+        return out;
+    }
+
+    RedisResult<void> RedisScript::check_loaded(const RedisValue& reply) const
+    {
+        if (!reply.is_bulk_string() && !reply.is_simple_string())
+        {
+            return std::unexpected(RedisError{RedisErrorCategory::Protocol, "SCRIPT LOAD: expected string"});
+        }
+        if (reply.as_string() != this->sha1_)
+        {
+            return std::unexpected(RedisError{
+                RedisErrorCategory::Protocol, "SCRIPT LOAD: sha1 mismatch " + reply.as_string() + " != " + this->sha1_
+            });
+        }
+        return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<RedisValue>> RedisScript::eval(
+        RedisClusterClient& cluster,
+        std::span<const std::string_view> keys,
+        std::span<const std::string_view> args) const
+    {
+        // RedisClusterClient::command() routes by the first argument, which is the SHA1 here
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            auto lease = keys.empty()
+                             ? co_await cluster.get_any_client()
+                             : co_await cluster.get_client_for_key(keys.front());
+            if (!lease) co_return std::unexpected(lease.error());
+
+            auto r = co_await this->eval(**lease, keys, args);
+            if (r || r.error().category != RedisErrorCategory::ServerReply) co_return r;
+
+            const auto& msg = r.error().message;
+            if (attempt == 0 && msg.starts_with("MOVED"))
+            {
+#ifdef UREDIS_LOGS
+                usub::ulog::warn("RedisScript::eval: {} on cluster, refreshing topology", msg);
+#endif
+                lease->release();
+                auto t = co_await cluster.refresh_topology();
+                if (!t) co_return std::unexpected(t.error());
+                continue;
+            }
+            co_return r;
+        }
+
+        co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisScript: cluster redirect retry failed"});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisScript::load(RedisClusterClient& cluster) const
+    {
+        auto r = co_await cluster.script_load(this->source_);
+        if (!r) co_return std::unexpected(r.error());
+        if (*r != this->sha1_)
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "SCRIPT LOAD: sha1 mismatch"});
+        }
+        co_return RedisResult<void>{};
+    }
+} // namespace usub::uredis
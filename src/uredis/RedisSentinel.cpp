@@ -32,6 +32,7 @@ namespace usub::uredis
             RedisConfig sent_cfg;
             sent_cfg.host = node.host;
             sent_cfg.port = node.port;
+            sent_cfg.unix_path = node.unix_path;
             sent_cfg.db   = 0;
 
             sent_cfg.username = node.username;
@@ -118,11 +119,18 @@ namespace usub::uredis
             master_cfg.host = master_host;
             master_cfg.port = master_port;
 
+            // base_redis.unix_path would pin every failover to one local server
+            master_cfg.unix_path.clear();
+            if (auto it = cfg.local_sockets.find(master_host + ":" + master_port_str);
+                it != cfg.local_sockets.end())
+            {
+                master_cfg.unix_path = it->second;
+            }
+
 #ifdef UREDIS_LOGS
             usub::ulog::info(
-                "RedisSentinel::resolve_master: resolved master {}:{} (db={})",
-                master_cfg.host,
-                master_cfg.port,
+                "RedisSentinel::resolve_master: resolved master {} (db={})",
+                RedisClient::endpoint(master_cfg),
                 master_cfg.db);
 #endif
 
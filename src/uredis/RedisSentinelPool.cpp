@@ -30,8 +30,8 @@ namespace usub::uredis
             co_return std::unexpected(c.error());
 
 #ifdef UREDIS_LOGS
-        usub::ulog::info("RedisSentinelPool: connected to master {}:{}",
-                         master_cfg.host, master_cfg.port);
+        usub::ulog::info("RedisSentinelPool: connected to master {}",
+                         RedisClient::endpoint(master_cfg));
 #endif
 
         master_ = std::move(client);
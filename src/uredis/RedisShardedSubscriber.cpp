@@ -0,0 +1,305 @@
+#include "uredis/RedisShardedSubscriber.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    RedisShardedSubscriber::RedisShardedSubscriber(Config cfg)
+        : cfg_(std::move(cfg))
+    {
+        std::size_t n = this->cfg_.connections;
+        if (n == 0)
+            n = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+        this->shards_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            this->shards_.push_back(std::make_unique<Shard>());
+            this->shards_.back()->index = i;
+        }
+    }
+
+    RedisShardedSubscriber::~RedisShardedSubscriber()
+    {
+        this->bg_->stopping.store(true);
+    }
+
+    std::size_t RedisShardedSubscriber::shard_of_channel(std::string_view channel) const
+    {
+        return std::hash<std::string_view>{}(channel) % this->shards_.size();
+    }
+
+    std::size_t RedisShardedSubscriber::shard_of_pattern(std::string_view pattern) const
+    {
+        auto it = this->cfg_.pattern_shards.find(std::string(pattern));
+        if (it != this->cfg_.pattern_shards.end())
+            return it->second % this->shards_.size();
+        return std::hash<std::string_view>{}(pattern) % this->shards_.size();
+    }
+
+    void RedisShardedSubscriber::notify_error(const RedisError& err) const
+    {
+        if (this->cfg_.on_error)
+            this->cfg_.on_error(err);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::connect_shard_locked(Shard& shard)
+    {
+        if (shard.subscriber && shard.subscriber->is_connected())
+        {
+            co_return RedisResult<void>{};
+        }
+
+        prune_retired_locked(shard);
+        if (shard.subscriber)
+            retire_locked(shard, std::move(shard.subscriber));
+
+        auto sub = std::make_shared<RedisSubscriber>(this->cfg_.redis, this->cfg_.dispatch);
+        auto c = co_await sub->connect();
+        if (!c)
+        {
+            // a failure after the socket connected (AUTH) leaves a reader behind
+            co_await sub->close();
+            retire_locked(shard, std::move(sub));
+            co_return std::unexpected(c.error());
+        }
+
+        auto bg = this->bg_;
+        Shard* sp = &shard;
+        sub->set_close_callback([this, bg, sp]()
+        {
+            if (!bg->enter()) return;
+            this->schedule_reconnect(*sp);
+            bg->leave();
+        });
+        shard.subscriber = sub;
+
+        std::vector<Subscription> channels;
+        channels.reserve(shard.channels.size());
+        for (const auto& [_, s] : shard.channels)
+            channels.push_back(s);
+
+        std::vector<Subscription> patterns;
+        patterns.reserve(shard.patterns.size());
+        for (const auto& [_, s] : shard.patterns)
+            patterns.push_back(s);
+
+        if (!channels.empty())
+        {
+            auto r = co_await sub->subscribe(channels);
+            if (!r) co_return r;
+        }
+        if (!patterns.empty())
+        {
+            auto r = co_await sub->psubscribe(patterns);
+            if (!r) co_return r;
+        }
+
+#ifdef UREDIS_LOGS
+        ulog::info("RedisShardedSubscriber: shard {} connected, {} channel(s), {} pattern(s)",
+                   shard.index, channels.size(), patterns.size());
+#endif
+        co_return RedisResult<void>{};
+    }
+
+    void RedisShardedSubscriber::retire_locked(Shard& shard, std::shared_ptr<RedisSubscriber> sub)
+    {
+        // the reader may still be running, keep the object alive until it returns
+        if (sub->reader_running())
+            shard.retired.push_back(std::move(sub));
+    }
+
+    void RedisShardedSubscriber::prune_retired_locked(Shard& shard)
+    {
+        std::erase_if(shard.retired, [](const std::shared_ptr<RedisSubscriber>& s)
+        {
+            return !s->reader_running();
+        });
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::connect()
+    {
+        RedisResult<void> result{};
+
+        for (auto& shard : this->shards_)
+        {
+            if (this->closed_.load(std::memory_order_acquire))
+            {
+                co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisShardedSubscriber closed"});
+            }
+
+            auto g = co_await shard->mutex.lock();
+            auto r = co_await this->connect_shard_locked(*shard);
+            if (!r)
+            {
+                this->notify_error(r.error());
+                this->schedule_reconnect(*shard);
+                if (result) result = r;
+            }
+        }
+
+        co_return result;
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::add(Shard& shard, bool pattern, Subscription sub)
+    {
+        if (this->closed_.load(std::memory_order_acquire))
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisShardedSubscriber closed"});
+        }
+
+        auto g = co_await shard.mutex.lock();
+
+        auto& desired = pattern ? shard.patterns : shard.channels;
+        desired[sub.name] = sub;
+
+        if (!shard.subscriber || !shard.subscriber->is_connected())
+        {
+            // a fresh connection subscribes everything the shard wants, including this one
+            auto c = co_await this->connect_shard_locked(shard);
+            if (!c) this->schedule_reconnect(shard);
+            co_return c;
+        }
+
+        auto one = std::span<const Subscription>(&sub, 1);
+        co_return pattern
+                      ? co_await shard.subscriber->psubscribe(one)
+                      : co_await shard.subscriber->subscribe(one);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::remove(Shard& shard, bool pattern, std::string name)
+    {
+        auto g = co_await shard.mutex.lock();
+
+        auto& desired = pattern ? shard.patterns : shard.channels;
+        desired.erase(name);
+
+        if (!shard.subscriber || !shard.subscriber->is_connected())
+        {
+            co_return RedisResult<void>{};
+        }
+
+        co_return pattern
+                      ? co_await shard.subscriber->punsubscribe(std::move(name))
+                      : co_await shard.subscriber->unsubscribe(std::move(name));
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::subscribe(std::string channel, MessageCallback cb)
+    {
+        auto& shard = *this->shards_[this->shard_of_channel(channel)];
+        co_return co_await this->add(shard, false, Subscription{std::move(channel), std::move(cb), {}});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::subscribe_view(std::string channel,
+                                                                              MessageViewCallback cb)
+    {
+        auto& shard = *this->shards_[this->shard_of_channel(channel)];
+        co_return co_await this->add(shard, false, Subscription{std::move(channel), {}, std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::psubscribe(std::string pattern, MessageCallback cb)
+    {
+        auto& shard = *this->shards_[this->shard_of_pattern(pattern)];
+        co_return co_await this->add(shard, true, Subscription{std::move(pattern), std::move(cb), {}});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::psubscribe_view(std::string pattern,
+                                                                               MessageViewCallback cb)
+    {
+        auto& shard = *this->shards_[this->shard_of_pattern(pattern)];
+        co_return co_await this->add(shard, true, Subscription{std::move(pattern), {}, std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::unsubscribe(std::string channel)
+    {
+        auto& shard = *this->shards_[this->shard_of_channel(channel)];
+        co_return co_await this->remove(shard, false, std::move(channel));
+    }
+
+    task::Awaitable<RedisResult<void>> RedisShardedSubscriber::punsubscribe(std::string pattern)
+    {
+        auto& shard = *this->shards_[this->shard_of_pattern(pattern)];
+        co_return co_await this->remove(shard, true, std::move(pattern));
+    }
+
+    void RedisShardedSubscriber::schedule_reconnect(Shard& shard)
+    {
+        if (this->closed_.load(std::memory_order_acquire)) return;
+        if (shard.reconnecting.exchange(true, std::memory_order_acq_rel)) return;
+        if (!this->bg_->enter())
+        {
+            shard.reconnecting.store(false, std::memory_order_release);
+            return;
+        }
+        system::co_spawn(this->reconnect(shard));
+    }
+
+    task::Awaitable<void> RedisShardedSubscriber::reconnect(Shard& shard)
+    {
+        auto bg = this->bg_;
+        const auto delay = std::chrono::milliseconds(std::max(this->cfg_.reconnect_delay_ms, 10));
+
+        for (;;)
+        {
+            // no ticket while sleeping, so close() does not wait out the delay
+            bg->leave();
+            co_await system::this_coroutine::sleep_for(delay);
+            if (!bg->enter()) co_return;
+
+            auto g = co_await shard.mutex.lock();
+            if (this->closed_.load(std::memory_order_acquire)) break;
+
+#ifdef UREDIS_LOGS
+            ulog::warn("RedisShardedSubscriber: reconnecting shard {}", shard.index);
+#endif
+            auto r = co_await this->connect_shard_locked(shard);
+            if (r) break;
+
+            this->notify_error(r.error());
+        }
+
+        shard.reconnecting.store(false, std::memory_order_release);
+        bg->leave();
+    }
+
+    task::Awaitable<void> RedisShardedSubscriber::close()
+    {
+        this->closed_.store(true, std::memory_order_release);
+        this->bg_->stopping.store(true);
+
+        for (auto& shard : this->shards_)
+        {
+            auto g = co_await shard->mutex.lock();
+            if (shard->subscriber)
+            {
+                co_await shard->subscriber->close();
+                retire_locked(*shard, std::move(shard->subscriber));
+            }
+            shard->channels.clear();
+            shard->patterns.clear();
+        }
+
+        if (this->bg_->running.load() > 0)
+            co_await this->bg_->idle.wait();
+
+        // readers return right after the shutdown
+        for (auto& shard : this->shards_)
+        {
+            for (;;)
+            {
+                {
+                    auto g = co_await shard->mutex.lock();
+                    prune_retired_locked(*shard);
+                    if (shard->retired.empty()) break;
+                }
+                co_await system::this_coroutine::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+} // namespace usub::uredis
@@ -0,0 +1,189 @@
+#include "uredis/RedisSlot.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(UREDIS_CRC16_PCLMUL) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UREDIS_CRC16_HAVE_PCLMUL 1
+#include <immintrin.h>
+#endif
+
+namespace usub::uredis {
+    namespace {
+        constexpr std::uint16_t crc16_poly = 0x1021;
+
+        using Crc16Tables = std::array<std::array<std::uint16_t, 256>, 8>;
+
+        constexpr Crc16Tables make_crc16_tables() {
+            Crc16Tables t{};
+
+            for (unsigned b = 0; b < 256; ++b) {
+                auto crc = static_cast<std::uint16_t>(b << 8);
+                for (int i = 0; i < 8; ++i) {
+                    if (crc & 0x8000)
+                        crc = static_cast<std::uint16_t>((crc << 1) ^ crc16_poly);
+                    else
+                        crc = static_cast<std::uint16_t>(crc << 1);
+                }
+                t[0][b] = crc;
+            }
+
+            // t[k][b] = CRC of byte b followed by k zero bytes.
+            for (std::size_t k = 1; k < t.size(); ++k) {
+                for (unsigned b = 0; b < 256; ++b) {
+                    const std::uint16_t prev = t[k - 1][b];
+                    t[k][b] = static_cast<std::uint16_t>((prev << 8) ^ t[0][prev >> 8]);
+                }
+            }
+
+            return t;
+        }
+
+        constexpr Crc16Tables crc16_tables = make_crc16_tables();
+
+        inline std::uint16_t crc16_update(std::uint16_t crc, const unsigned char *p, std::size_t n) noexcept {
+            const auto &t = crc16_tables;
+
+            while (n >= 8) {
+                const auto b0 = static_cast<unsigned char>(p[0] ^ (crc >> 8));
+                const auto b1 = static_cast<unsigned char>(p[1] ^ (crc & 0xff));
+                crc = static_cast<std::uint16_t>(
+                    t[7][b0] ^ t[6][b1] ^ t[5][p[2]] ^ t[4][p[3]] ^
+                    t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]]);
+                p += 8;
+                n -= 8;
+            }
+
+            while (n--) {
+                crc = static_cast<std::uint16_t>((crc << 8) ^ t[0][static_cast<unsigned char>((crc >> 8) ^ *p++)]);
+            }
+
+            return crc;
+        }
+
+#ifdef UREDIS_CRC16_HAVE_PCLMUL
+        // x^n mod P(x), used as folding constants.
+        constexpr std::uint64_t xpow_mod(unsigned n) {
+            std::uint32_t r = 1;
+            for (unsigned i = 0; i < n; ++i) {
+                r <<= 1;
+                if (r & 0x10000u)
+                    r ^= 0x10000u | crc16_poly;
+            }
+            return r;
+        }
+
+        constexpr std::uint64_t fold_k64 = xpow_mod(64);
+        constexpr std::uint64_t fold_k128 = xpow_mod(128);
+        constexpr std::uint64_t fold_k192 = xpow_mod(192);
+
+        constexpr std::size_t pclmul_min_len = 64;
+
+        // Folds 16-byte blocks with carry-less multiplies down to a 64-bit
+        // remainder congruent to the message mod P, then finishes with the table.
+        __attribute__((target("pclmul,ssse3")))
+        std::uint16_t crc16_pclmul(const unsigned char *p, std::size_t n) noexcept {
+            const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+            __m128i acc;
+            const std::size_t head = n % 16;
+            if (head != 0) {
+                alignas(16) unsigned char buf[16]{};
+                std::memcpy(buf + 16 - head, p, head);
+                acc = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(buf)), bswap);
+                p += head;
+                n -= head;
+            } else {
+                acc = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), bswap);
+                p += 16;
+                n -= 16;
+            }
+
+            const __m128i k = _mm_set_epi64x(static_cast<long long>(fold_k192), static_cast<long long>(fold_k128));
+            while (n != 0) {
+                const __m128i blk = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), bswap);
+                const __m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);
+                const __m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);
+                acc = _mm_xor_si128(_mm_xor_si128(hi, lo), blk);
+                p += 16;
+                n -= 16;
+            }
+
+            const __m128i k64 = _mm_set_epi64x(0, static_cast<long long>(fold_k64));
+            acc = _mm_xor_si128(_mm_clmulepi64_si128(acc, k64, 0x01), _mm_move_epi64(acc));
+            acc = _mm_xor_si128(_mm_clmulepi64_si128(acc, k64, 0x01), _mm_move_epi64(acc));
+
+            const auto w = static_cast<std::uint64_t>(_mm_cvtsi128_si64(acc));
+            unsigned char be[8];
+            for (int i = 0; i < 8; ++i)
+                be[i] = static_cast<unsigned char>(w >> (56 - 8 * i));
+
+            return crc16_update(0, be, sizeof(be));
+        }
+
+        bool cpu_has_pclmul() noexcept {
+            static const bool has = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+            return has;
+        }
+#endif
+    } // namespace
+
+    std::uint16_t crc16_slice8(std::string_view data) noexcept {
+        return crc16_update(0, reinterpret_cast<const unsigned char *>(data.data()), data.size());
+    }
+
+    std::uint16_t crc16(std::string_view data) noexcept {
+#ifdef UREDIS_CRC16_HAVE_PCLMUL
+        if (data.size() >= pclmul_min_len && cpu_has_pclmul())
+            return crc16_pclmul(reinterpret_cast<const unsigned char *>(data.data()), data.size());
+#endif
+        return crc16_slice8(data);
+    }
+
+    std::string_view hash_tag(std::string_view key) noexcept {
+        const auto *begin = key.data();
+        const auto *l = static_cast<const char *>(std::memchr(begin, '{', key.size()));
+        if (!l) return key;
+
+        const std::size_t rest = key.size() - static_cast<std::size_t>(l - begin) - 1;
+        const auto *r = static_cast<const char *>(std::memchr(l + 1, '}', rest));
+        if (!r || r == l + 1) return key;
+
+        return std::string_view{l + 1, static_cast<std::size_t>(r - l - 1)};
+    }
+
+    std::uint16_t slot_of(std::string_view key) noexcept {
+        if (key.empty()) return 0;
+        return static_cast<std::uint16_t>(crc16(hash_tag(key)) & (cluster_slot_count - 1));
+    }
+
+    void slots_of(std::span<const std::string_view> keys, std::span<std::uint16_t> out) noexcept {
+        const std::size_t n = keys.size() < out.size() ? keys.size() : out.size();
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = slot_of(keys[i]);
+    }
+
+    std::vector<std::uint16_t> slots_of(std::span<const std::string_view> keys) {
+        std::vector<std::uint16_t> out(keys.size());
+        slots_of(keys, std::span<std::uint16_t>(out.data(), out.size()));
+        return out;
+    }
+
+    std::vector<RedisSlotGroup> group_by_slot(std::span<const std::string_view> keys) {
+        // (slot << 32 | index) sorts by slot and keeps input order within a slot
+        std::vector<std::uint64_t> tagged(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            tagged[i] = (static_cast<std::uint64_t>(slot_of(keys[i])) << 32) | static_cast<std::uint32_t>(i);
+        std::sort(tagged.begin(), tagged.end());
+
+        std::vector<RedisSlotGroup> out;
+        for (const auto t: tagged) {
+            const auto slot = static_cast<std::uint16_t>(t >> 32);
+            if (out.empty() || out.back().slot != slot)
+                out.push_back(RedisSlotGroup{slot, {}});
+            out.back().indices.push_back(static_cast<std::size_t>(t & 0xffffffffu));
+        }
+        return out;
+    }
+} // namespace usub::uredis
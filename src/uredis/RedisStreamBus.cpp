@@ -0,0 +1,480 @@
+#include "uredis/RedisStreamBus.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    RedisStreamBus::RedisStreamBus(Config cfg)
+        : cfg_(std::move(cfg))
+    {
+        this->consumer_ = this->cfg_.consumer;
+        if (this->consumer_.empty())
+        {
+            std::random_device rd;
+            const std::uint64_t id = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+            char name[24];
+            std::snprintf(name, sizeof(name), "c-%016llx", static_cast<unsigned long long>(id));
+            this->consumer_ = name;
+        }
+
+        if (this->cfg_.maxlen > 0)
+            this->maxlen_ = std::to_string(this->cfg_.maxlen);
+
+        this->streams_.store(std::make_shared<const Streams>());
+
+        const std::size_t n = std::max<std::size_t>(1, this->cfg_.publish_connections);
+        this->publishers_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            this->publishers_.push_back(std::make_shared<RedisMultiplexedConnection>(
+                this->cfg_.redis, this->cfg_.max_inflight_per_publisher));
+        }
+    }
+
+    std::string RedisStreamBus::stream_key(std::string_view channel) const
+    {
+        std::string key;
+        key.reserve(this->cfg_.key_prefix.size() + channel.size());
+        key.append(this->cfg_.key_prefix);
+        key.append(channel);
+        return key;
+    }
+
+    std::shared_ptr<RedisMultiplexedConnection> RedisStreamBus::pick_publisher() const
+    {
+        auto best = this->publishers_.front();
+        for (const auto& p : this->publishers_)
+        {
+            if (p->inflight() < best->inflight())
+                best = p;
+        }
+        return best;
+    }
+
+    void RedisStreamBus::notify_error(const RedisError& err) const
+    {
+        if (this->cfg_.on_error)
+            this->cfg_.on_error(err);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamBus::publish(
+        std::string_view channel,
+        std::string_view payload)
+    {
+        if (this->stopping_.load(std::memory_order_acquire))
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisStreamBus: closed"});
+        }
+
+        const auto key = this->stream_key(channel);
+        auto pub = this->pick_publisher();
+
+        auto resp = this->maxlen_.empty()
+                        ? co_await pub->command("XADD", key, "*", "p", payload)
+                        : co_await pub->command("XADD", key, "MAXLEN", "~", this->maxlen_, "*", "p", payload);
+        if (!resp)
+        {
+            auto err = resp.error();
+#ifdef UREDIS_LOGS
+            usub::ulog::error("RedisStreamBus::publish: XADD {} failed: {}", key, err.message);
+#endif
+            this->notify_error(err);
+            co_return std::unexpected(err);
+        }
+
+        co_return RedisResult<void>{};
+    }
+
+    void RedisStreamBus::publish_detached(std::string channel, std::string payload)
+    {
+        if (this->stopping_.load(std::memory_order_acquire))
+        {
+            this->notify_error(RedisError{RedisErrorCategory::Io, "RedisStreamBus: closed"});
+            return;
+        }
+
+        system::co_spawn(publish_task(this->pick_publisher(), this->stream_key(channel), this->maxlen_,
+                                      std::move(payload), this->cfg_.on_error));
+    }
+
+    task::Awaitable<void> RedisStreamBus::publish_task(
+        std::shared_ptr<RedisMultiplexedConnection> pub,
+        std::string key,
+        std::string maxlen,
+        std::string payload,
+        std::function<void(const RedisError&)> on_error)
+    {
+        auto resp = maxlen.empty()
+                        ? co_await pub->command("XADD", key, "*", "p", payload)
+                        : co_await pub->command("XADD", key, "MAXLEN", "~", maxlen, "*", "p", payload);
+        if (!resp && on_error)
+            on_error(resp.error());
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamBus::ensure_groups(std::span<const std::string> keys)
+    {
+        if (keys.empty())
+        {
+            co_return RedisResult<void>{};
+        }
+
+        std::vector<std::array<std::string_view, 5>> args;
+        args.reserve(keys.size());
+        std::vector<RedisCommandView> cmds;
+        cmds.reserve(keys.size());
+        for (const auto& key : keys)
+        {
+            args.push_back({"CREATE", key, this->cfg_.group, "$", "MKSTREAM"});
+            cmds.push_back(RedisCommandView{"XGROUP", args.back()});
+        }
+
+        auto resp = co_await this->pick_publisher()->pipeline_chunked(cmds);
+        if (!resp)
+        {
+            co_return std::unexpected(resp.error());
+        }
+
+        for (const auto& r : *resp)
+        {
+            // BUSYGROUP: the group already exists
+            if (!r && r.error().message.find("BUSYGROUP") == std::string::npos)
+            {
+                co_return std::unexpected(r.error());
+            }
+        }
+
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamBus::subscribe(
+        std::string channel,
+        Callback cb)
+    {
+        co_return co_await this->subscribe(std::span<const std::string>(&channel, 1), std::move(cb));
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamBus::subscribe(
+        std::span<const std::string> channels,
+        Callback cb)
+    {
+        if (this->stopping_.load(std::memory_order_acquire))
+        {
+            co_return std::unexpected(RedisError{RedisErrorCategory::Io, "RedisStreamBus: closed"});
+        }
+
+        std::vector<std::string> keys;
+        keys.reserve(channels.size());
+        for (const auto& ch : channels)
+            keys.push_back(this->stream_key(ch));
+
+        auto guard = co_await this->mutex_.lock();
+
+        auto r = co_await this->ensure_groups(keys);
+        if (!r)
+        {
+            auto err = r.error();
+#ifdef UREDIS_LOGS
+            usub::ulog::error("RedisStreamBus::subscribe: XGROUP CREATE ({} streams) failed: {}",
+                              keys.size(), err.message);
+#endif
+            this->notify_error(err);
+            co_return std::unexpected(err);
+        }
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            this->desired_[keys[i]] = Stream{channels[i], cb};
+        this->streams_.store(std::make_shared<const Streams>(this->desired_), std::memory_order_release);
+
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamBus::unsubscribe(std::string channel)
+    {
+        auto guard = co_await this->mutex_.lock();
+
+        this->desired_.erase(this->stream_key(channel));
+        this->streams_.store(std::make_shared<const Streams>(this->desired_), std::memory_order_release);
+
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<bool>> RedisStreamBus::ensure_reader()
+    {
+        if (this->reader_ && this->reader_->connected())
+        {
+            co_return false;
+        }
+
+        // the blocking read must not trip the socket timeout
+        RedisConfig rc = this->cfg_.redis;
+        rc.io_timeout_ms = std::max(rc.io_timeout_ms, this->cfg_.block_ms + 1000);
+
+        auto reader = std::make_shared<RedisClient>(rc);
+        auto c = co_await reader->connect();
+        if (!c)
+        {
+            co_return std::unexpected(c.error());
+        }
+
+        this->reader_ = std::move(reader);
+#ifdef UREDIS_LOGS
+        usub::ulog::info("RedisStreamBus: reader connected, consumer {}", this->consumer_);
+#endif
+        co_return true;
+    }
+
+    void RedisStreamBus::dispatch(const Stream& stream, const std::string& key, const RedisValue& entries,
+                                  Acks& acks) const
+    {
+        auto decoded = decode_stream_entries(entries);
+        if (!decoded)
+        {
+            this->notify_error(decoded.error());
+            return;
+        }
+
+        auto& ids = acks.ids[key];
+        for (const auto& e : *decoded)
+        {
+            // an entry trimmed away while pending has no fields: acknowledge only
+            if (!e.deleted && stream.cb)
+            {
+                if (auto payload = e.get("p"))
+                    stream.cb(stream.channel, std::string(*payload));
+            }
+
+            ids.emplace_back(e.id);
+            ++acks.count;
+        }
+    }
+
+    task::Awaitable<RedisResult<bool>> RedisStreamBus::read_batch(const Streams& streams, bool pending, Acks& acks)
+    {
+        const auto count = std::to_string(std::max<std::size_t>(1, this->cfg_.read_count));
+        const auto block = std::to_string(std::max(this->cfg_.block_ms, 0));
+
+        std::vector<std::string_view> args;
+        args.reserve(9 + streams.size() * 2);
+        args.insert(args.end(), {"GROUP", this->cfg_.group, this->consumer_, "COUNT", count});
+        // id "0" re-reads this consumer's own pending entries and never blocks
+        if (!pending)
+            args.insert(args.end(), {"BLOCK", block});
+        args.push_back("STREAMS");
+        for (const auto& [key, _] : streams)
+            args.push_back(key);
+        for (std::size_t i = 0; i < streams.size(); ++i)
+            args.push_back(pending ? "0" : ">");
+
+        auto resp = co_await this->reader_->command("XREADGROUP", std::span<const std::string_view>(args));
+        if (!resp)
+        {
+            co_return std::unexpected(resp.error());
+        }
+
+        // null: BLOCK timed out
+        if (!resp->is_array())
+        {
+            co_return false;
+        }
+
+        const std::size_t before = acks.count;
+        for (const auto& s : resp->as_array())
+        {
+            if (!s.is_array() || s.as_array().size() < 2 || !s.as_array()[0].is_bulk_string()) continue;
+
+            const auto& key = s.as_array()[0].as_string();
+            auto it = streams.find(key);
+            if (it == streams.end()) continue;
+
+            this->dispatch(it->second, key, s.as_array()[1], acks);
+        }
+
+        co_return acks.count > before;
+    }
+
+    task::Awaitable<void> RedisStreamBus::claim_stuck(const Streams& streams, Acks& acks)
+    {
+        const auto count = std::to_string(std::max<std::size_t>(1, this->cfg_.read_count));
+        const auto min_idle = std::to_string(std::max(this->cfg_.claim_min_idle_ms, 0));
+
+        for (const auto& [key, stream] : streams)
+        {
+            std::string cursor = "0-0";
+            do
+            {
+                std::array<std::string_view, 7> args{
+                    key, this->cfg_.group, this->consumer_, min_idle, cursor, "COUNT", count
+                };
+                auto resp = co_await this->reader_->command("XAUTOCLAIM", std::span<const std::string_view>(args));
+                if (!resp)
+                {
+                    this->notify_error(resp.error());
+                    co_return;
+                }
+                if (!resp->is_array() || resp->as_array().size() < 2) break;
+
+                const auto& arr = resp->as_array();
+                [[maybe_unused]] const std::size_t before = acks.count;
+                this->dispatch(stream, key, arr[1], acks);
+
+#ifdef UREDIS_LOGS
+                if (acks.count > before)
+                    usub::ulog::warn("RedisStreamBus: claimed {} stuck entries on {}", acks.count - before, key);
+#endif
+
+                co_await this->flush_acks(acks);
+                cursor = arr[0].is_bulk_string() ? arr[0].as_string() : std::string("0-0");
+            }
+            while (cursor != "0-0" && !this->stopping_.load(std::memory_order_acquire));
+        }
+    }
+
+    task::Awaitable<void> RedisStreamBus::flush_acks(Acks& acks)
+    {
+        if (acks.count == 0)
+        {
+            co_return;
+        }
+
+        std::vector<std::vector<std::string_view>> args;
+        args.reserve(acks.ids.size());
+        std::vector<RedisCommandView> cmds;
+        cmds.reserve(acks.ids.size());
+        for (const auto& [key, ids] : acks.ids)
+        {
+            if (ids.empty()) continue;
+
+            auto& a = args.emplace_back();
+            a.reserve(ids.size() + 2);
+            a.push_back(key);
+            a.push_back(this->cfg_.group);
+            a.insert(a.end(), ids.begin(), ids.end());
+            cmds.push_back(RedisCommandView{"XACK", a});
+        }
+
+        // unacknowledged entries stay pending and are redelivered by the pending read or XAUTOCLAIM
+        auto resp = co_await this->pick_publisher()->pipeline_chunked(cmds);
+        if (!resp)
+        {
+            this->notify_error(resp.error());
+        }
+        else
+        {
+            for (const auto& r : *resp)
+            {
+                if (!r) this->notify_error(r.error());
+            }
+        }
+
+        acks.ids.clear();
+        acks.count = 0;
+    }
+
+    task::Awaitable<void> RedisStreamBus::on_read_error(const RedisError& err, const Streams& streams)
+    {
+#ifdef UREDIS_LOGS
+        usub::ulog::warn("RedisStreamBus::run: XREADGROUP failed: {}", err.message);
+#endif
+        this->notify_error(err);
+
+        // the stream or the group was deleted behind our back
+        if (err.category == RedisErrorCategory::ServerReply && err.message.find("NOGROUP") != std::string::npos)
+        {
+            std::vector<std::string> keys;
+            keys.reserve(streams.size());
+            for (const auto& [key, _] : streams)
+                keys.push_back(key);
+
+            auto r = co_await this->ensure_groups(keys);
+            if (r) co_return;
+            this->notify_error(r.error());
+        }
+
+        co_await system::this_coroutine::sleep_for(
+            std::chrono::milliseconds(this->cfg_.reconnect_delay_ms));
+    }
+
+    task::Awaitable<void> RedisStreamBus::run()
+    {
+        if (this->running_.exchange(true, std::memory_order_acq_rel))
+        {
+            co_return;
+        }
+
+        using clock = std::chrono::steady_clock;
+        const auto claim_interval = std::chrono::milliseconds(std::max(this->cfg_.claim_interval_ms, 1));
+        auto last_claim = clock::now();
+
+        Acks acks;
+        std::shared_ptr<const Streams> last;
+        bool recover = true;
+
+        while (!this->stopping_.load(std::memory_order_acquire))
+        {
+            auto streams = this->streams_.load(std::memory_order_acquire);
+            if (streams->empty())
+            {
+                co_await system::this_coroutine::sleep_for(
+                    std::chrono::milliseconds(std::clamp(this->cfg_.block_ms, 1, 100)));
+                continue;
+            }
+
+            // new streams may hold entries left pending by an earlier run of this consumer
+            if (streams != last)
+            {
+                recover = true;
+                last = streams;
+            }
+
+            auto fresh = co_await this->ensure_reader();
+            if (!fresh)
+            {
+                this->notify_error(fresh.error());
+                co_await system::this_coroutine::sleep_for(
+                    std::chrono::milliseconds(this->cfg_.reconnect_delay_ms));
+                continue;
+            }
+            if (*fresh) recover = true;
+
+            auto r = co_await this->read_batch(*streams, recover, acks);
+            co_await this->flush_acks(acks);
+            if (!r)
+            {
+                co_await this->on_read_error(r.error(), *streams);
+                continue;
+            }
+            if (recover && !*r) recover = false;
+
+            if (clock::now() - last_claim >= claim_interval)
+            {
+                co_await this->claim_stuck(*streams, acks);
+                last_claim = clock::now();
+            }
+        }
+
+        co_await this->flush_acks(acks);
+        this->running_.store(false, std::memory_order_release);
+        this->stopped_.set();
+    }
+
+    task::Awaitable<void> RedisStreamBus::close()
+    {
+        this->stopping_.store(true, std::memory_order_release);
+
+        // the read loop flushes its acks over the publishers, wait for it first
+        if (this->running_.load(std::memory_order_acquire))
+            co_await this->stopped_.wait();
+
+        for (auto& p : this->publishers_)
+            p->close();
+
+        co_return;
+    }
+} // namespace usub::uredis
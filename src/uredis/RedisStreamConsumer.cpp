@@ -0,0 +1,444 @@
+#include "uredis/RedisStreamConsumer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis
+{
+    struct RedisStreamConsumer::Batch
+    {
+        struct Item
+        {
+            std::string_view stream;
+            const StreamEntry* entry;
+        };
+
+        RedisValue reply; // owns everything the entries point into
+        std::vector<StreamRead> reads;
+        std::vector<Item> items;
+        std::vector<char> ok;
+
+        std::atomic<std::size_t> remaining{0};
+        sync::AsyncEvent done{sync::Reset::Manual, false};
+    };
+
+    RedisStreamConsumer::RedisStreamConsumer(Config cfg, Handler handler)
+        : cfg_(std::move(cfg))
+          , handler_(std::move(handler))
+          , control_(cfg_.redis, 1024)
+    {
+        if (this->cfg_.consumer.empty())
+        {
+            std::random_device rd;
+            const std::uint64_t id = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+            char name[24];
+            std::snprintf(name, sizeof(name), "c-%016llx", static_cast<unsigned long long>(id));
+            this->cfg_.consumer = name;
+        }
+    }
+
+    void RedisStreamConsumer::notify_error(const RedisError& err) const
+    {
+        if (this->cfg_.on_error)
+            this->cfg_.on_error(err);
+    }
+
+    RedisStreamConsumer::Stats RedisStreamConsumer::stats() const
+    {
+        Stats s;
+        s.delivered = this->delivered_.load(std::memory_order_relaxed);
+        s.acked = this->acked_.load(std::memory_order_relaxed);
+        s.rejected = this->rejected_.load(std::memory_order_relaxed);
+        s.claimed = this->claimed_.load(std::memory_order_relaxed);
+        s.lag = this->lag_.load(std::memory_order_relaxed);
+        s.pending = this->pending_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    task::Awaitable<RedisResult<void>> RedisStreamConsumer::create_groups()
+    {
+        std::vector<std::array<std::string_view, 5>> args;
+        args.reserve(this->cfg_.streams.size());
+        std::vector<RedisCommandView> cmds;
+        cmds.reserve(this->cfg_.streams.size());
+        for (const auto& s : this->cfg_.streams)
+        {
+            args.push_back({"CREATE", s, this->cfg_.group, this->cfg_.start_id, "MKSTREAM"});
+            cmds.push_back(RedisCommandView{"XGROUP", args.back()});
+        }
+
+        auto resp = co_await this->control_.pipeline_chunked(cmds);
+        if (!resp)
+        {
+            co_return std::unexpected(resp.error());
+        }
+        for (const auto& r : *resp)
+        {
+            if (!r && r.error().message.find("BUSYGROUP") == std::string::npos)
+            {
+                co_return std::unexpected(r.error());
+            }
+        }
+        co_return RedisResult<void>{};
+    }
+
+    task::Awaitable<RedisResult<bool>> RedisStreamConsumer::ensure_reader()
+    {
+        if (this->reader_ && this->reader_->connected())
+        {
+            co_return false;
+        }
+
+        RedisConfig rc = this->cfg_.redis;
+        rc.io_timeout_ms = std::max(rc.io_timeout_ms, this->cfg_.block_ms + 1000);
+
+        auto reader = std::make_shared<RedisClient>(rc);
+        auto c = co_await reader->connect();
+        if (!c)
+        {
+            co_return std::unexpected(c.error());
+        }
+
+        this->reader_ = std::move(reader);
+        co_return true;
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::worker(std::shared_ptr<Batch> batch, const Handler* handler,
+                                                      std::size_t first, std::size_t step)
+    {
+        for (std::size_t i = first; i < batch->items.size(); i += step)
+        {
+            const auto& item = batch->items[i];
+            // trimmed while pending: nothing to handle, acknowledge
+            batch->ok[i] = item.entry->deleted ? true : co_await (*handler)(item.stream, *item.entry);
+        }
+
+        if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            batch->done.set();
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::process(std::shared_ptr<Batch> batch)
+    {
+        const std::size_t n = batch->items.size();
+        batch->ok.assign(n, 0);
+
+        const std::size_t workers = std::min(std::max<std::size_t>(1, this->cfg_.concurrency), n);
+        if (workers <= 1)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const auto& item = batch->items[i];
+                batch->ok[i] = item.entry->deleted ? true : co_await this->handler_(item.stream, *item.entry);
+            }
+        }
+        else
+        {
+            batch->remaining.store(workers, std::memory_order_release);
+            for (std::size_t w = 0; w < workers; ++w)
+                system::co_spawn(worker(batch, &this->handler_, w, workers));
+            co_await batch->done.wait();
+        }
+
+        co_await this->ack(*batch);
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::ack(const Batch& batch)
+    {
+        // one XACK per stream for the whole batch
+        std::unordered_map<std::string_view, std::vector<std::string_view>> per_stream;
+        std::size_t acked = 0;
+        std::size_t rejected = 0;
+        for (std::size_t i = 0; i < batch.items.size(); ++i)
+        {
+            if (!batch.ok[i])
+            {
+                ++rejected;
+                continue;
+            }
+
+            auto& ids = per_stream[batch.items[i].stream];
+            if (ids.empty())
+            {
+                ids.push_back(batch.items[i].stream);
+                ids.push_back(this->cfg_.group);
+            }
+            ids.push_back(batch.items[i].entry->id);
+            ++acked;
+        }
+        this->rejected_.fetch_add(rejected, std::memory_order_relaxed);
+
+        if (per_stream.empty())
+        {
+            co_return;
+        }
+
+        std::vector<RedisCommandView> cmds;
+        cmds.reserve(per_stream.size());
+        for (const auto& [_, args] : per_stream)
+            cmds.push_back(RedisCommandView{"XACK", args});
+
+        // unacknowledged entries stay pending and come back through XAUTOCLAIM
+        auto resp = co_await this->control_.pipeline_chunked(cmds);
+        if (!resp)
+        {
+            this->notify_error(resp.error());
+            co_return;
+        }
+        for (const auto& r : *resp)
+        {
+            if (!r) this->notify_error(r.error());
+        }
+        this->acked_.fetch_add(acked, std::memory_order_relaxed);
+    }
+
+    task::Awaitable<RedisResult<bool>> RedisStreamConsumer::read_round(std::vector<std::string>* pending_from)
+    {
+        const auto count = std::to_string(std::max<std::size_t>(1, this->cfg_.batch_size));
+        const auto block = std::to_string(std::max(this->cfg_.block_ms, 0));
+
+        std::vector<std::string_view> args;
+        args.reserve(8 + this->cfg_.streams.size() * 2);
+        args.insert(args.end(), {"GROUP", this->cfg_.group, this->cfg_.consumer, "COUNT", count});
+        // an explicit id reads this consumer's own pending entries, e.g. after a restart; never blocks
+        if (!pending_from)
+            args.insert(args.end(), {"BLOCK", block});
+        args.push_back("STREAMS");
+        for (const auto& s : this->cfg_.streams)
+            args.push_back(s);
+        for (std::size_t i = 0; i < this->cfg_.streams.size(); ++i)
+            args.push_back(pending_from ? std::string_view((*pending_from)[i]) : std::string_view(">"));
+
+        auto resp = co_await this->reader_->command("XREADGROUP", std::span<const std::string_view>(args));
+        if (!resp)
+        {
+            co_return std::unexpected(resp.error());
+        }
+
+        auto batch = std::make_shared<Batch>();
+        batch->reply = std::move(*resp);
+
+        auto reads = decode_stream_read(batch->reply);
+        if (!reads)
+        {
+            co_return std::unexpected(reads.error());
+        }
+        batch->reads = std::move(*reads);
+
+        for (const auto& read : batch->reads)
+        {
+            for (const auto& e : read.entries)
+                batch->items.push_back(Batch::Item{read.stream, &e});
+
+            // rejected entries stay pending, so the next page starts past them
+            if (pending_from && !read.entries.empty())
+            {
+                auto it = std::find(this->cfg_.streams.begin(), this->cfg_.streams.end(), read.stream);
+                if (it != this->cfg_.streams.end())
+                    (*pending_from)[it - this->cfg_.streams.begin()] = std::string(read.entries.back().id);
+            }
+        }
+        if (batch->items.empty())
+        {
+            co_return false;
+        }
+
+        this->delivered_.fetch_add(batch->items.size(), std::memory_order_relaxed);
+        co_await this->process(batch);
+        co_return true;
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::claim_round()
+    {
+        const auto count = std::to_string(std::max<std::size_t>(1, this->cfg_.batch_size));
+        const auto min_idle = std::to_string(std::max(this->cfg_.claim_min_idle_ms, 0));
+
+        for (const auto& stream : this->cfg_.streams)
+        {
+            std::string cursor = "0-0";
+            do
+            {
+                const std::array<std::string_view, 7> args{
+                    stream, this->cfg_.group, this->cfg_.consumer, min_idle, cursor, "COUNT", count
+                };
+                auto resp = co_await this->control_.command("XAUTOCLAIM", std::span<const std::string_view>(args));
+                if (!resp)
+                {
+                    this->notify_error(resp.error());
+                    co_return;
+                }
+
+                auto batch = std::make_shared<Batch>();
+                batch->reply = std::move(*resp);
+
+                auto claim = decode_stream_claim(batch->reply);
+                if (!claim)
+                {
+                    this->notify_error(claim.error());
+                    co_return;
+                }
+                cursor = std::string(claim->next);
+
+                auto& read = batch->reads.emplace_back();
+                read.stream = stream;
+                read.entries = std::move(claim->entries);
+                for (const auto& e : read.entries)
+                    batch->items.push_back(Batch::Item{read.stream, &e});
+
+                if (!batch->items.empty())
+                {
+#ifdef UREDIS_LOGS
+                    ulog::warn("RedisStreamConsumer: claimed {} idle entries on {}", batch->items.size(), stream);
+#endif
+                    this->claimed_.fetch_add(batch->items.size(), std::memory_order_relaxed);
+                    this->delivered_.fetch_add(batch->items.size(), std::memory_order_relaxed);
+                    co_await this->process(batch);
+                }
+            }
+            while (cursor != "0-0" && !this->stopping_.load(std::memory_order_acquire));
+        }
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::refresh_metrics()
+    {
+        std::int64_t lag = 0;
+        std::int64_t pending = 0;
+        bool lag_known = true;
+
+        for (const auto& stream : this->cfg_.streams)
+        {
+            auto resp = co_await this->control_.command("XINFO", "GROUPS", stream);
+            if (!resp)
+            {
+                this->notify_error(resp.error());
+                co_return;
+            }
+            if (!resp->is_array()) co_return;
+
+            for (const auto& g : resp->as_array())
+            {
+                if (!g.is_array()) continue;
+                const auto& kv = g.as_array();
+
+                const RedisValue* name = nullptr;
+                const RedisValue* g_lag = nullptr;
+                const RedisValue* g_pending = nullptr;
+                for (std::size_t i = 0; i + 1 < kv.size(); i += 2)
+                {
+                    if (!kv[i].is_bulk_string() && !kv[i].is_simple_string()) continue;
+                    const auto& key = kv[i].as_string();
+                    if (key == "name") name = &kv[i + 1];
+                    else if (key == "lag") g_lag = &kv[i + 1];
+                    else if (key == "pending") g_pending = &kv[i + 1];
+                }
+
+                if (!name || name->as_optional_string() != this->cfg_.group) continue;
+
+                // lag is null when Redis cannot tell (e.g. after XDEL), missing before Redis 7
+                if (g_lag && g_lag->is_integer()) lag += g_lag->as_integer();
+                else lag_known = false;
+                if (g_pending && g_pending->is_integer()) pending += g_pending->as_integer();
+            }
+        }
+
+        this->lag_.store(lag_known ? lag : -1, std::memory_order_relaxed);
+        this->pending_.store(pending, std::memory_order_relaxed);
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::run()
+    {
+        if (this->cfg_.streams.empty() || this->running_.exchange(true, std::memory_order_acq_rel))
+        {
+            co_return;
+        }
+
+        using clock = std::chrono::steady_clock;
+        const auto delay = std::chrono::milliseconds(this->cfg_.reconnect_delay_ms);
+        const auto claim_interval = std::chrono::milliseconds(std::max(this->cfg_.claim_interval_ms, 1));
+        const auto metrics_interval = std::chrono::milliseconds(this->cfg_.metrics_interval_ms);
+        auto last_claim = clock::now();
+        auto last_metrics = clock::time_point{};
+
+        bool groups_ready = !this->cfg_.create_group;
+        // own pending entries still to page through, one start id per stream; empty when done
+        std::vector<std::string> pending_from;
+
+        while (!this->stopping_.load(std::memory_order_acquire))
+        {
+            if (!groups_ready)
+            {
+                auto g = co_await this->create_groups();
+                if (!g)
+                {
+                    this->notify_error(g.error());
+                    co_await system::this_coroutine::sleep_for(delay);
+                    continue;
+                }
+                groups_ready = true;
+            }
+
+            auto fresh = co_await this->ensure_reader();
+            if (!fresh)
+            {
+                this->notify_error(fresh.error());
+                co_await system::this_coroutine::sleep_for(delay);
+                continue;
+            }
+            if (*fresh) pending_from.assign(this->cfg_.streams.size(), "0");
+
+            auto r = co_await this->read_round(pending_from.empty() ? nullptr : &pending_from);
+            if (!r)
+            {
+                const auto& err = r.error();
+#ifdef UREDIS_LOGS
+                ulog::warn("RedisStreamConsumer::run: XREADGROUP failed: {}", err.message);
+#endif
+                this->notify_error(err);
+                if (this->cfg_.create_group && err.message.find("NOGROUP") != std::string::npos)
+                {
+                    groups_ready = false;
+                    continue;
+                }
+                co_await system::this_coroutine::sleep_for(delay);
+                continue;
+            }
+            // the own PEL is read once, page by page: entries the handler rejects stay there for
+            // XAUTOCLAIM
+            if (!pending_from.empty() && !*r)
+                pending_from.clear();
+
+            const auto now = clock::now();
+            if (now - last_claim >= claim_interval)
+            {
+                co_await this->claim_round();
+                last_claim = clock::now();
+            }
+            if (this->cfg_.metrics_interval_ms > 0 && now - last_metrics >= metrics_interval)
+            {
+                co_await this->refresh_metrics();
+                last_metrics = clock::now();
+            }
+        }
+
+        this->running_.store(false, std::memory_order_release);
+        this->stopped_.set();
+    }
+
+    task::Awaitable<void> RedisStreamConsumer::close()
+    {
+        this->stopping_.store(true, std::memory_order_release);
+
+        if (this->running_.load(std::memory_order_acquire))
+            co_await this->stopped_.wait();
+
+        this->control_.close();
+        co_return;
+    }
+} // namespace usub::uredis
@@ -0,0 +1,102 @@
+#include "uredis/RedisStreams.h"
+
+namespace usub::uredis
+{
+    namespace
+    {
+        bool is_text(const RedisValue& v)
+        {
+            return v.is_bulk_string() || v.is_simple_string();
+        }
+
+        RedisError malformed(std::string_view what)
+        {
+            return RedisError{RedisErrorCategory::Protocol, std::string(what) + ": malformed stream reply"};
+        }
+
+        bool decode_into(const RedisValue& entries, std::vector<StreamEntry>& out)
+        {
+            if (entries.is_null()) return true;
+            if (!entries.is_array()) return false;
+
+            const auto& arr = entries.as_array();
+            out.reserve(out.size() + arr.size());
+            for (const auto& e : arr)
+            {
+                if (!e.is_array() || e.as_array().empty() || !is_text(e.as_array()[0])) return false;
+
+                const auto& entry = e.as_array();
+                StreamEntry se;
+                se.id = entry[0].as_string();
+
+                if (entry.size() < 2 || entry[1].is_null())
+                {
+                    se.deleted = true;
+                }
+                else
+                {
+                    if (!entry[1].is_array()) return false;
+                    const auto& fields = entry[1].as_array();
+                    if (fields.size() % 2 != 0) return false;
+                    for (const auto& f : fields)
+                    {
+                        if (!is_text(f)) return false;
+                    }
+                    se.raw = std::span<const RedisValue>(fields);
+                }
+
+                out.push_back(se);
+            }
+            return true;
+        }
+    }
+
+    RedisResult<std::vector<StreamEntry>> decode_stream_entries(const RedisValue& entries)
+    {
+        std::vector<StreamEntry> out;
+        if (!decode_into(entries, out)) return std::unexpected(malformed("entries"));
+        return out;
+    }
+
+    RedisResult<std::vector<StreamRead>> decode_stream_read(const RedisValue& reply)
+    {
+        std::vector<StreamRead> out;
+        if (reply.is_null()) return out;
+        if (!reply.is_array()) return std::unexpected(malformed("XREAD"));
+
+        const auto& arr = reply.as_array();
+        out.reserve(arr.size());
+        for (const auto& s : arr)
+        {
+            if (!s.is_array() || s.as_array().size() != 2 || !is_text(s.as_array()[0]))
+                return std::unexpected(malformed("XREAD"));
+
+            auto& read = out.emplace_back();
+            read.stream = s.as_array()[0].as_string();
+            if (!decode_into(s.as_array()[1], read.entries))
+                return std::unexpected(malformed("XREAD"));
+        }
+        return out;
+    }
+
+    RedisResult<StreamClaim> decode_stream_claim(const RedisValue& reply)
+    {
+        if (!reply.is_array() || reply.as_array().size() < 2 || !is_text(reply.as_array()[0]))
+            return std::unexpected(malformed("XAUTOCLAIM"));
+
+        const auto& arr = reply.as_array();
+        StreamClaim out;
+        out.next = arr[0].as_string();
+        if (!decode_into(arr[1], out.entries))
+            return std::unexpected(malformed("XAUTOCLAIM"));
+
+        if (arr.size() > 2 && arr[2].is_array())
+        {
+            for (const auto& id : arr[2].as_array())
+            {
+                if (is_text(id)) out.deleted.push_back(id.as_string());
+            }
+        }
+        return out;
+    }
+} // namespace usub::uredis
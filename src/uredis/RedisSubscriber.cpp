@@ -1,5 +1,10 @@
 #include "uredis/RedisSubscriber.h"
 
+#include "uvent/sync/AsyncSemaphore.h"
+#include "uvent/utils/datastructures/queue/ConcurrentQueues.h"
+
+#include <algorithm>
+#include <bit>
 #include <charconv>
 
 #ifdef UREDIS_LOGS
@@ -15,6 +20,187 @@ namespace usub::uredis
     {
     }
 
+    RedisSubscriber::RedisSubscriber(RedisConfig cfg, DispatchOptions dispatch)
+        : config_(std::move(cfg))
+        , dispatch_(dispatch)
+    {
+    }
+
+    struct RedisSubscriber::DispatchQueue
+    {
+        struct Item
+        {
+            std::string channel;
+            std::string payload;
+        };
+
+        DispatchQueue(std::size_t capacity_, OverflowPolicy overflow_, Handler handler_)
+            : items(std::bit_ceil(capacity_))
+            , capacity(capacity_)
+            , overflow(overflow_)
+            , handler(std::move(handler_))
+        {
+        }
+
+        usub::queue::concurrent::MPMCQueue<Item> items;
+        std::size_t capacity;
+        OverflowPolicy overflow;
+        Handler handler;
+
+        std::atomic<std::size_t> depth{0};
+        std::atomic<std::uint64_t> delivered{0};
+        std::atomic<std::uint64_t> dropped{0};
+
+        sync::AsyncSemaphore ready{0};
+        sync::AsyncSemaphore space{0};
+        std::atomic<bool> producer_waiting{false};
+        std::atomic<bool> stopped{false};
+
+        // false: full under OverflowPolicy::Block
+        bool try_push(std::string_view channel, std::string_view payload)
+        {
+            if (this->stopped.load(std::memory_order_acquire))
+                return true;
+
+            if (this->depth.load(std::memory_order_acquire) >= this->capacity)
+            {
+                if (this->overflow == OverflowPolicy::Block)
+                    return false;
+
+                if (this->overflow == OverflowPolicy::DropNewest)
+                {
+                    this->dropped.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+
+                Item oldest;
+                if (this->items.try_dequeue(oldest))
+                {
+                    this->depth.fetch_sub(1, std::memory_order_acq_rel);
+                    this->dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            if (!this->items.try_enqueue(Item{std::string(channel), std::string(payload)}))
+            {
+                this->dropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            this->depth.fetch_add(1, std::memory_order_acq_rel);
+            this->ready.release();
+            return true;
+        }
+
+        // Already queued messages are still delivered.
+        void stop()
+        {
+            this->stopped.store(true, std::memory_order_release);
+            this->ready.release();
+            this->space.release();
+        }
+    };
+
+    task::Awaitable<void> RedisSubscriber::dispatch_worker(std::shared_ptr<DispatchQueue> q)
+    {
+        DispatchQueue::Item item;
+
+        for (;;)
+        {
+            co_await q->ready.acquire();
+
+            if (!q->items.try_dequeue(item))
+            {
+                if (q->stopped.load(std::memory_order_acquire)) break;
+                continue;
+            }
+
+            q->depth.fetch_sub(1, std::memory_order_acq_rel);
+            if (q->producer_waiting.exchange(false, std::memory_order_acq_rel))
+                q->space.release();
+
+            q->handler(item.channel, item.payload);
+            q->delivered.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    task::Awaitable<void> RedisSubscriber::push_blocking(std::shared_ptr<DispatchQueue> q,
+                                                         std::string_view channel,
+                                                         std::string_view payload)
+    {
+        while (!q->try_push(channel, payload))
+        {
+            q->producer_waiting.store(true, std::memory_order_release);
+            // the worker may have made room before it could see the flag
+            if (q->depth.load(std::memory_order_acquire) < q->capacity)
+            {
+                q->producer_waiting.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            co_await q->space.acquire();
+        }
+    }
+
+    void RedisSubscriber::set_handler(HandlerMap& map, const std::string& name, Handler handler)
+    {
+        if (this->dispatch_.queue_capacity > 0)
+        {
+            handler.queue = std::make_shared<DispatchQueue>(
+                this->dispatch_.queue_capacity, this->dispatch_.overflow, handler);
+            system::co_spawn(dispatch_worker(handler.queue));
+        }
+
+        auto it = map.find(name);
+        if (it == map.end())
+        {
+            map.emplace(name, std::move(handler));
+            return;
+        }
+
+        if (it->second.queue) it->second.queue->stop();
+        it->second = std::move(handler);
+    }
+
+    bool RedisSubscriber::erase_handler(HandlerMap& map, const std::string& name)
+    {
+        auto it = map.find(name);
+        if (it == map.end()) return false;
+
+        if (it->second.queue) it->second.queue->stop();
+        map.erase(it);
+        return true;
+    }
+
+    void RedisSubscriber::stop_queues()
+    {
+        for (auto* map : {&this->channel_handlers_, &this->pattern_handlers_, &this->shard_handlers_})
+        {
+            for (auto& [_, h] : *map)
+            {
+                if (h.queue) h.queue->stop();
+            }
+        }
+    }
+
+    std::vector<RedisSubscriber::DispatchStats> RedisSubscriber::dispatch_stats() const
+    {
+        std::vector<DispatchStats> out;
+        for (const auto* map : {&this->channel_handlers_, &this->pattern_handlers_, &this->shard_handlers_})
+        {
+            for (const auto& [name, h] : *map)
+            {
+                if (!h.queue) continue;
+                out.push_back(DispatchStats{
+                    name,
+                    h.queue->depth.load(std::memory_order_relaxed),
+                    h.queue->delivered.load(std::memory_order_relaxed),
+                    h.queue->dropped.load(std::memory_order_relaxed)
+                });
+            }
+        }
+        return out;
+    }
+
     std::vector<uint8_t> RedisSubscriber::encode_command(
         std::string_view cmd,
         std::span<const std::string_view> args)
@@ -56,26 +242,22 @@ namespace usub::uredis
             co_return RedisResult<void>{};
         }
 
-        std::string port_str = std::to_string(this->config_.port);
-
 #ifdef UREDIS_LOGS
-        ulog::info("RedisSubscriber::connect: host={} port={}",
-                     this->config_.host,
-                     this->config_.port);
+        ulog::info("RedisSubscriber::connect: endpoint={}", RedisClient::endpoint(this->config_));
 #endif
 
-        auto res = co_await this->socket_.async_connect(this->config_.host.c_str(),
-                                                        port_str.c_str());
-        if (res.has_value())
+        auto sock = co_await RedisClient::open_socket(this->config_);
+        if (!sock)
         {
-            RedisError err{RedisErrorCategory::Io, "async_connect failed"};
-            co_return std::unexpected(err);
+            co_return std::unexpected(sock.error());
         }
 
-        this->socket_.set_timeout_ms(this->config_.io_timeout_ms);
+        this->socket_ = std::move(*sock);
+        this->socket_->set_timeout_ms(this->config_.io_timeout_ms);
         this->connected_ = true;
         this->closing_ = false;
 
+        this->reader_running_.store(true, std::memory_order_release);
         system::co_spawn(this->reader_loop());
 
         if (this->config_.password.has_value())
@@ -103,8 +285,8 @@ namespace usub::uredis
             auto frame = encode_command("AUTH", span_args);
             {
                 auto w = co_await this->write_mutex_.lock();
-                auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-                this->socket_.update_timeout(this->config_.io_timeout_ms);
+                auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+                this->socket_->update_timeout(this->config_.io_timeout_ms);
                 if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
                 {
                     RedisError err{RedisErrorCategory::Io, "AUTH write failed"};
@@ -122,8 +304,8 @@ namespace usub::uredis
                                         std::span<const std::string_view>(args_arr, 1));
 
             auto w = co_await this->write_mutex_.lock();
-            auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
             if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
             {
                 RedisError err{RedisErrorCategory::Io, "SELECT write failed"};
@@ -144,7 +326,7 @@ namespace usub::uredis
         }
 
         auto st = std::make_shared<PendingSub>();
-        st->callback = std::move(cb);
+        st->callback.owned = std::move(cb);
         std::string key = channel;
 
         this->pending_sub_.emplace(key, st);
@@ -155,8 +337,8 @@ namespace usub::uredis
 
         {
             auto w = co_await this->write_mutex_.lock();
-            auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
             if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
             {
                 this->pending_sub_.erase(key);
@@ -178,7 +360,7 @@ namespace usub::uredis
         }
 
         auto st = std::make_shared<PendingSub>();
-        st->callback = std::move(cb);
+        st->callback.owned = std::move(cb);
         std::string key = pattern;
 
         this->pending_psub_.emplace(key, st);
@@ -189,8 +371,8 @@ namespace usub::uredis
 
         {
             auto w = co_await this->write_mutex_.lock();
-            auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
             if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
             {
                 this->pending_psub_.erase(key);
@@ -203,6 +385,121 @@ namespace usub::uredis
         co_return st->result;
     }
 
+    task::Awaitable<RedisResult<void>> RedisSubscriber::subscribe_many(
+        std::string_view cmd,
+        std::unordered_map<std::string, std::shared_ptr<PendingSub>>& pending,
+        std::span<const Subscription> subs)
+    {
+        if (!this->connected_)
+        {
+            RedisError err{RedisErrorCategory::Io, "RedisSubscriber not connected"};
+            co_return std::unexpected(err);
+        }
+
+        std::vector<std::shared_ptr<PendingSub>> states;
+        std::vector<std::string_view> names;
+        states.reserve(subs.size());
+        names.reserve(subs.size());
+
+        for (const auto& sub : subs)
+        {
+            auto [it, inserted] = pending.try_emplace(sub.name, nullptr);
+            if (inserted)
+            {
+                it->second = std::make_shared<PendingSub>();
+                it->second->callback = Handler{.owned = sub.callback, .view = sub.view_callback};
+                names.push_back(it->first);
+            }
+            // already requested (here or by another call): wait for the same confirmation
+            states.push_back(it->second);
+        }
+
+        std::vector<uint8_t> out;
+        for (std::size_t i = 0; i < names.size(); i += max_names_per_frame)
+        {
+            const auto n = std::min(max_names_per_frame, names.size() - i);
+            auto frame = encode_command(cmd, std::span<const std::string_view>(names.data() + i, n));
+            out.insert(out.end(), frame.begin(), frame.end());
+        }
+
+        if (!out.empty())
+        {
+            auto w = co_await this->write_mutex_.lock();
+
+            // thousands of names make a buffer of hundreds of KB: short writes are normal here
+            std::size_t off = 0;
+            while (off < out.size())
+            {
+                auto wrsz = co_await this->socket_->async_write(out.data() + off, out.size() - off);
+                this->socket_->update_timeout(this->config_.io_timeout_ms);
+                if (wrsz <= 0)
+                {
+                    for (auto name : names)
+                        pending.erase(std::string(name));
+                    // a frame cut short would desync every later command: drop the connection,
+                    // the reader fails the other waiters and reports the close
+                    this->socket_->shutdown();
+                    RedisError err{RedisErrorCategory::Io, std::string(cmd) + " write failed"};
+                    co_return std::unexpected(err);
+                }
+                off += static_cast<std::size_t>(wrsz);
+            }
+        }
+
+        RedisResult<void> result{};
+        for (auto& st : states)
+        {
+            co_await st->event.wait();
+            if (!st->result && result)
+                result = st->result;
+        }
+        co_return result;
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::subscribe(std::span<const Subscription> channels)
+    {
+        co_return co_await this->subscribe_many("SUBSCRIBE", this->pending_sub_, channels);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::psubscribe(std::span<const Subscription> patterns)
+    {
+        co_return co_await this->subscribe_many("PSUBSCRIBE", this->pending_psub_, patterns);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::subscribe(std::span<const std::string> channels,
+                                                                  MessageCallback cb)
+    {
+        std::vector<Subscription> subs;
+        subs.reserve(channels.size());
+        for (const auto& ch : channels)
+            subs.push_back(Subscription{.name = ch, .callback = cb});
+        co_return co_await this->subscribe_many("SUBSCRIBE", this->pending_sub_, subs);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::psubscribe(std::span<const std::string> patterns,
+                                                                   MessageCallback cb)
+    {
+        std::vector<Subscription> subs;
+        subs.reserve(patterns.size());
+        for (const auto& pat : patterns)
+            subs.push_back(Subscription{.name = pat, .callback = cb});
+        co_return co_await this->subscribe_many("PSUBSCRIBE", this->pending_psub_, subs);
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::subscribe_view(std::string channel, MessageViewCallback cb)
+    {
+        Subscription sub{std::move(channel), {}, std::move(cb)};
+        co_return co_await this->subscribe_many("SUBSCRIBE", this->pending_sub_,
+                                                std::span<const Subscription>(&sub, 1));
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::psubscribe_view(std::string pattern, MessageViewCallback cb)
+    {
+        Subscription sub{std::move(pattern), {}, std::move(cb)};
+        co_return co_await this->subscribe_many("PSUBSCRIBE", this->pending_psub_,
+                                                std::span<const Subscription>(&sub, 1));
+    }
+
     task::Awaitable<RedisResult<void>> RedisSubscriber::unsubscribe(std::string channel)
     {
         if (!this->connected_)
@@ -221,8 +518,8 @@ namespace usub::uredis
 
         {
             auto w = co_await this->write_mutex_.lock();
-            auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
             if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
             {
                 this->pending_unsub_.erase(key);
@@ -253,8 +550,8 @@ namespace usub::uredis
 
         {
             auto w = co_await this->write_mutex_.lock();
-            auto wrsz = co_await this->socket_.async_write(frame.data(), frame.size());
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
             if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
             {
                 this->pending_punsub_.erase(key);
@@ -267,11 +564,99 @@ namespace usub::uredis
         co_return st->result;
     }
 
+    task::Awaitable<RedisResult<void>> RedisSubscriber::ssubscribe(std::string channel, MessageCallback cb)
+    {
+        co_return co_await this->ssubscribe_handler(std::move(channel), Handler{.owned = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::ssubscribe_view(std::string channel, MessageViewCallback cb)
+    {
+        co_return co_await this->ssubscribe_handler(std::move(channel), Handler{.view = std::move(cb)});
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::ssubscribe_handler(std::string channel, Handler handler)
+    {
+        if (!this->connected_)
+        {
+            RedisError err{RedisErrorCategory::Io, "RedisSubscriber not connected"};
+            co_return std::unexpected(err);
+        }
+
+        auto st = std::make_shared<PendingSub>();
+        st->callback = std::move(handler);
+        std::string key = channel;
+
+        this->pending_ssub_.emplace(key, st);
+
+        std::string_view args_arr[1] = {key};
+        auto frame = encode_command("SSUBSCRIBE",
+                                    std::span<const std::string_view>(args_arr, 1));
+
+        {
+            auto w = co_await this->write_mutex_.lock();
+            this->ssub_order_.push_back(key);
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
+            if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
+            {
+                this->pending_ssub_.erase(key);
+                std::erase(this->ssub_order_, key);
+                RedisError err{RedisErrorCategory::Io, "SSUBSCRIBE write failed"};
+                co_return std::unexpected(err);
+            }
+        }
+
+        co_await st->event.wait();
+        co_return st->result;
+    }
+
+    task::Awaitable<RedisResult<void>> RedisSubscriber::sunsubscribe(std::string channel)
+    {
+        if (!this->connected_)
+        {
+            RedisError err{RedisErrorCategory::Io, "RedisSubscriber not connected"};
+            co_return std::unexpected(err);
+        }
+
+        auto st = std::make_shared<PendingUnsub>();
+        std::string key = channel;
+        this->pending_sunsub_.emplace(key, st);
+
+        std::string_view args_arr[1] = {key};
+        auto frame = encode_command("SUNSUBSCRIBE",
+                                    std::span<const std::string_view>(args_arr, 1));
+
+        {
+            auto w = co_await this->write_mutex_.lock();
+            auto wrsz = co_await this->socket_->async_write(frame.data(), frame.size());
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
+            if (wrsz <= 0 || static_cast<std::size_t>(wrsz) != frame.size())
+            {
+                this->pending_sunsub_.erase(key);
+                RedisError err{RedisErrorCategory::Io, "SUNSUBSCRIBE write failed"};
+                co_return std::unexpected(err);
+            }
+        }
+
+        co_await st->event.wait();
+        co_return st->result;
+    }
+
+    void RedisSubscriber::set_sunsubscribe_callback(ChannelEventCallback cb)
+    {
+        this->on_sunsubscribe_ = std::move(cb);
+    }
+
+    void RedisSubscriber::set_close_callback(CloseCallback cb)
+    {
+        this->on_close_ = std::move(cb);
+    }
+
     task::Awaitable<void> RedisSubscriber::close()
     {
         this->closing_ = true;
         this->connected_ = false;
-        this->socket_.shutdown();
+        if (this->socket_) this->socket_->shutdown();
         co_return;
     }
 
@@ -299,11 +684,62 @@ namespace usub::uredis
             st->result = std::unexpected(err);
             st->event.set();
         }
+        for (auto& [_, st] : this->pending_ssub_)
+        {
+            st->result = std::unexpected(err);
+            st->event.set();
+        }
+        for (auto& [_, st] : this->pending_sunsub_)
+        {
+            st->result = std::unexpected(err);
+            st->event.set();
+        }
 
         this->pending_sub_.clear();
         this->pending_psub_.clear();
         this->pending_unsub_.clear();
         this->pending_punsub_.clear();
+        this->pending_ssub_.clear();
+        this->pending_sunsub_.clear();
+        this->ssub_order_.clear();
+    }
+
+    std::shared_ptr<RedisSubscriber::DispatchQueue> RedisSubscriber::dispatch_push(const RespParser::PushMessage& m)
+    {
+        using Kind = RespParser::PushMessage::Kind;
+
+        const HandlerMap* handlers = nullptr;
+        std::string_view key = m.channel;
+        switch (m.kind)
+        {
+        case Kind::Message:
+            handlers = &this->channel_handlers_;
+            break;
+        case Kind::PMessage:
+            handlers = &this->pattern_handlers_;
+            key = m.pattern;
+            break;
+        case Kind::SMessage:
+            handlers = &this->shard_handlers_;
+            break;
+        default:
+            return nullptr;
+        }
+
+        auto it = handlers->find(key);
+        if (it == handlers->end())
+            return nullptr;
+
+        const auto& h = it->second;
+        if (!h.queue)
+        {
+            h(m.channel, m.payload);
+            return nullptr;
+        }
+
+        if (h.queue->try_push(m.channel, m.payload))
+            return nullptr;
+        return h.queue;
     }
 
     void RedisSubscriber::handle_array(RedisValue&& v)
@@ -315,34 +751,7 @@ namespace usub::uredis
 
         const std::string& kind = arr[0].as_string();
 
-        if (kind == "message")
-        {
-            if (arr.size() < 3) return;
-            const std::string& channel = arr[1].as_string();
-            const std::string& payload = arr[2].as_string();
-
-            auto it = this->channel_handlers_.find(channel);
-            if (it != this->channel_handlers_.end() && it->second)
-            {
-                it->second(channel, payload);
-            }
-            return;
-        }
-
-        if (kind == "pmessage")
-        {
-            if (arr.size() < 4) return;
-            const std::string& pattern = arr[1].as_string();
-            const std::string& channel = arr[2].as_string();
-            const std::string& payload = arr[3].as_string();
-
-            auto it = this->pattern_handlers_.find(pattern);
-            if (it != this->pattern_handlers_.end() && it->second)
-            {
-                it->second(channel, payload);
-            }
-            return;
-        }
+        // message / pmessage / smessage are handled by dispatch_push()
 
         if (kind == "subscribe")
         {
@@ -352,7 +761,7 @@ namespace usub::uredis
             if (it != this->pending_sub_.end())
             {
                 auto st = it->second;
-                this->channel_handlers_[channel] = st->callback;
+                this->set_handler(this->channel_handlers_, channel, st->callback);
                 st->result = RedisResult<void>{};
                 st->event.set();
                 this->pending_sub_.erase(it);
@@ -368,7 +777,7 @@ namespace usub::uredis
             if (it != this->pending_psub_.end())
             {
                 auto st = it->second;
-                this->pattern_handlers_[pattern] = st->callback;
+                this->set_handler(this->pattern_handlers_, pattern, st->callback);
                 st->result = RedisResult<void>{};
                 st->event.set();
                 this->pending_psub_.erase(it);
@@ -380,7 +789,7 @@ namespace usub::uredis
         {
             if (arr.size() < 2) return;
             const std::string& channel = arr[1].as_string();
-            this->channel_handlers_.erase(channel);
+            erase_handler(this->channel_handlers_, channel);
             auto it = this->pending_unsub_.find(channel);
             if (it != this->pending_unsub_.end())
             {
@@ -392,11 +801,49 @@ namespace usub::uredis
             return;
         }
 
+        if (kind == "ssubscribe")
+        {
+            if (arr.size() < 2) return;
+            const std::string& channel = arr[1].as_string();
+            std::erase(this->ssub_order_, channel);
+            auto it = this->pending_ssub_.find(channel);
+            if (it != this->pending_ssub_.end())
+            {
+                auto st = it->second;
+                this->set_handler(this->shard_handlers_, channel, st->callback);
+                st->result = RedisResult<void>{};
+                st->event.set();
+                this->pending_ssub_.erase(it);
+            }
+            return;
+        }
+
+        if (kind == "sunsubscribe")
+        {
+            if (arr.size() < 2) return;
+            const std::string channel = arr[1].as_string();
+            const bool had_handler = erase_handler(this->shard_handlers_, channel);
+            auto it = this->pending_sunsub_.find(channel);
+            if (it != this->pending_sunsub_.end())
+            {
+                auto st = it->second;
+                st->result = RedisResult<void>{};
+                st->event.set();
+                this->pending_sunsub_.erase(it);
+            }
+            else if (had_handler && this->on_sunsubscribe_)
+            {
+                // server-side: the slot of the channel moved to another node
+                this->on_sunsubscribe_(channel);
+            }
+            return;
+        }
+
         if (kind == "punsubscribe")
         {
             if (arr.size() < 2) return;
             const std::string& pattern = arr[1].as_string();
-            this->pattern_handlers_.erase(pattern);
+            erase_handler(this->pattern_handlers_, pattern);
             auto it = this->pending_punsub_.find(pattern);
             if (it != this->pending_punsub_.end())
             {
@@ -409,6 +856,24 @@ namespace usub::uredis
         }
     }
 
+    void RedisSubscriber::handle_error(const std::string& msg)
+    {
+        // Subscribe-family confirmations are pushes keyed by channel; the only request that
+        // can fail with an error reply here is SSUBSCRIBE to a node not owning the slot.
+        if (this->ssub_order_.empty()) return;
+
+        std::string channel = std::move(this->ssub_order_.front());
+        this->ssub_order_.pop_front();
+
+        auto it = this->pending_ssub_.find(channel);
+        if (it == this->pending_ssub_.end()) return;
+
+        auto st = it->second;
+        st->result = std::unexpected(RedisError{RedisErrorCategory::ServerReply, msg});
+        st->event.set();
+        this->pending_ssub_.erase(it);
+    }
+
     task::Awaitable<void> RedisSubscriber::reader_loop()
     {
 #ifdef UREDIS_LOGS
@@ -421,8 +886,8 @@ namespace usub::uredis
         while (!this->closing_)
         {
             buf.clear();
-            ssize_t rdsz = co_await this->socket_.async_read(buf, max_read_size);
-            this->socket_.update_timeout(this->config_.io_timeout_ms);
+            ssize_t rdsz = co_await this->socket_->async_read(buf, max_read_size);
+            this->socket_->update_timeout(this->config_.io_timeout_ms);
 
             if (rdsz <= 0)
             {
@@ -436,6 +901,15 @@ namespace usub::uredis
 
             while (true)
             {
+                auto push = this->parser_.next_push();
+                if (push.kind == RespParser::PushMessage::Kind::Incomplete) break;
+                if (push.kind != RespParser::PushMessage::Kind::Other)
+                {
+                    if (auto q = this->dispatch_push(push))
+                        co_await push_blocking(std::move(q), push.channel, push.payload);
+                    continue;
+                }
+
                 auto val_opt = this->parser_.next();
                 if (!val_opt) break;
 
@@ -451,19 +925,29 @@ namespace usub::uredis
                     ulog::error("RedisSubscriber::reader_loop: server error: {}",
                                   v.as_string());
 #endif
+                    this->handle_error(v.as_string());
                 }
             }
         }
 
+        const bool requested = this->closing_;
+
         this->closing_ = true;
         this->connected_ = false;
-        this->socket_.shutdown();
+        this->socket_->shutdown();
 
         this->fail_all(RedisErrorCategory::Io, "subscriber connection closed");
+        this->stop_queues();
+
+        if (!requested && this->on_close_)
+        {
+            this->on_close_();
+        }
 
 #ifdef UREDIS_LOGS
         ulog::info("RedisSubscriber::reader_loop: stop");
 #endif
+        this->reader_running_.store(false, std::memory_order_release);
         co_return;
     }
 } // namespace usub::uredis
@@ -0,0 +1,141 @@
+#include "uredis/RedisTransaction.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef UREDIS_LOGS
+#include <ulog/ulog.h>
+#endif
+
+namespace usub::uredis {
+    namespace system = usub::uvent::system;
+
+    std::size_t RedisTransaction::append(std::string_view s) {
+        const std::size_t off = buf_.size();
+        buf_.append(s);
+        return off;
+    }
+
+    RedisTransaction &RedisTransaction::add(std::string_view cmd, std::span<const std::string_view> args) {
+        Cmd c;
+        c.name_off = append(cmd);
+        c.name_len = cmd.size();
+        c.first_arg = args_.size();
+        c.arg_count = args.size();
+        for (auto a: args) args_.emplace_back(append(a), a.size());
+        cmds_.push_back(c);
+        return *this;
+    }
+
+    void RedisTransaction::clear() noexcept {
+        buf_.clear();
+        args_.clear();
+        cmds_.clear();
+    }
+
+    task::Awaitable<RedisResult<std::optional<RedisTransaction::Results> > > RedisTransaction::exec(
+        RedisClient &client) const {
+        if (cmds_.empty())
+            co_return std::optional<Results>{Results{}};
+
+        std::vector<std::string_view> args;
+        args.reserve(args_.size());
+        for (const auto &[off, len]: args_) args.emplace_back(buf_.data() + off, len);
+
+        std::vector<RedisCommandView> frame;
+        frame.reserve(cmds_.size() + 2);
+        frame.push_back(RedisCommandView{"MULTI", {}});
+        for (const auto &c: cmds_) {
+            frame.push_back(RedisCommandView{
+                std::string_view(buf_.data() + c.name_off, c.name_len),
+                std::span<const std::string_view>(args.data() + c.first_arg, c.arg_count)
+            });
+        }
+        frame.push_back(RedisCommandView{"EXEC", {}});
+
+        auto resp = co_await client.pipeline(frame);
+        if (!resp) co_return std::unexpected(resp.error());
+
+        auto &replies = *resp;
+        if (replies.size() != frame.size())
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "EXEC: reply count mismatch"});
+
+        if (!replies.front()) co_return std::unexpected(replies.front().error());
+
+        auto &exec = replies.back();
+        if (!exec) {
+            // EXECABORT: report the command that failed to queue
+            for (std::size_t i = 1; i + 1 < replies.size(); ++i) {
+                if (!replies[i]) {
+                    auto err = replies[i].error();
+                    err.message = "EXECABORT: command " + std::to_string(i - 1) + ": " + err.message;
+                    co_return std::unexpected(std::move(err));
+                }
+            }
+            co_return std::unexpected(exec.error());
+        }
+
+        if (exec->is_null()) co_return std::optional<Results>{};
+
+        if (!exec->is_array() || exec->as_array().size() != cmds_.size())
+            co_return std::unexpected(RedisError{RedisErrorCategory::Protocol, "EXEC: unexpected reply"});
+
+        Results out;
+        out.reserve(cmds_.size());
+        for (auto &v: std::get<RedisValue::Array>(exec->value)) {
+            if (v.is_error())
+                out.push_back(std::unexpected(RedisError{RedisErrorCategory::ServerReply, v.as_string()}));
+            else
+                out.push_back(std::move(v));
+        }
+        co_return std::optional<Results>{std::move(out)};
+    }
+
+    task::Awaitable<RedisResult<RedisTransaction::Results> > RedisTransaction::watch(
+        RedisClient &client,
+        std::span<const std::string_view> keys,
+        std::span<const RedisCommandView> reads,
+        Builder build,
+        RedisWatchOptions opts) {
+        const int attempts = std::max(opts.max_attempts, 1);
+        int backoff_ms = std::max(opts.backoff_initial_ms, 0);
+
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            std::vector<RedisCommandView> first;
+            first.reserve(reads.size() + 1);
+            first.push_back(RedisCommandView{"WATCH", keys});
+            first.insert(first.end(), reads.begin(), reads.end());
+
+            auto r = co_await client.pipeline(first);
+            if (!r) co_return std::unexpected(r.error());
+            if (!r->front()) co_return std::unexpected(r->front().error());
+
+            RedisTransaction tx;
+            auto b = build(std::span<const RedisResult<RedisValue> >(r->data() + 1, r->size() - 1), tx);
+            if (!b || tx.empty()) {
+                std::string_view none[1];
+                auto u = co_await client.command("UNWATCH", std::span<const std::string_view>(none, 0));
+                if (!b) co_return std::unexpected(b.error());
+                if (!u) co_return std::unexpected(u.error());
+                co_return Results{};
+            }
+
+            // EXEC clears the WATCH, whatever its outcome
+            auto e = co_await tx.exec(client);
+            if (!e) co_return std::unexpected(e.error());
+            if (*e) co_return std::move(**e);
+
+#ifdef UREDIS_LOGS
+            ulog::debug("RedisTransaction::watch: EXEC aborted, attempt={} backoff_ms={}", attempt, backoff_ms);
+#endif
+            if (attempt + 1 < attempts && backoff_ms > 0) {
+                co_await system::this_coroutine::sleep_for(std::chrono::milliseconds(backoff_ms));
+                backoff_ms = std::min(backoff_ms * 2, std::max(opts.backoff_max_ms, 1));
+            }
+        }
+
+        co_return std::unexpected(RedisError{
+            RedisErrorCategory::ServerReply, "WATCH: transaction aborted " + std::to_string(attempts) + " times"
+        });
+    }
+} // namespace usub::uredis
@@ -66,6 +66,90 @@ namespace usub::uredis
         return this->parse_value();
     }
 
+    RespParser::PushMessage RespParser::next_push()
+    {
+        using Kind = PushMessage::Kind;
+
+        this->compact_if_needed();
+
+        PushMessage out;
+        const char* b = reinterpret_cast<const char*>(this->buffer_.data());
+        const std::size_t end = this->buffer_.size();
+        std::size_t p = this->pos_;
+
+        // 1: read, 0: incomplete, -1: not a push message
+        auto read_len = [b, end, &p](char prefix, std::size_t& n) -> int
+        {
+            if (p >= end) return 0;
+            if (b[p] != prefix) return -1;
+
+            std::size_t q = p + 1;
+            n = 0;
+            while (q < end && b[q] >= '0' && b[q] <= '9')
+            {
+                if (q - p > 18) return -1;
+                n = n * 10 + static_cast<std::size_t>(b[q] - '0');
+                ++q;
+            }
+            if (q < end && (q == p + 1 || b[q] != '\r')) return -1;
+            if (q + 1 >= end) return 0;
+            if (b[q + 1] != '\n') return -1;
+
+            p = q + 2;
+            return 1;
+        };
+
+        auto read_bulk = [b, end, &p, &read_len](std::string_view& sv) -> int
+        {
+            std::size_t n{};
+            const int r = read_len('$', n);
+            if (r <= 0) return r;
+            if (end - p < n + 2) return 0;
+            if (b[p + n] != '\r' || b[p + n + 1] != '\n') return -1;
+
+            sv = std::string_view(b + p, n);
+            p += n + 2;
+            return 1;
+        };
+
+        auto result = [&out](int r) -> PushMessage&
+        {
+            out.kind = r == 0 ? Kind::Incomplete : Kind::Other;
+            return out;
+        };
+
+        std::size_t count{};
+        int r = read_len('*', count);
+        if (r <= 0) return result(r);
+        if (count != 3 && count != 4) return out;
+
+        std::string_view kind;
+        r = read_bulk(kind);
+        if (r <= 0) return result(r);
+
+        // dispatch on length and first byte, then confirm the rest
+        switch (kind.size())
+        {
+        case 7:
+            if (count == 3 && kind[0] == 'm' && kind == "message") out.kind = Kind::Message;
+            break;
+        case 8:
+            if (count == 4 && kind[0] == 'p' && kind == "pmessage") out.kind = Kind::PMessage;
+            else if (count == 3 && kind[0] == 's' && kind == "smessage") out.kind = Kind::SMessage;
+            break;
+        default:
+            break;
+        }
+        if (out.kind == Kind::Other) return out;
+
+        if (out.kind == Kind::PMessage && (r = read_bulk(out.pattern)) <= 0) return result(r);
+        if ((r = read_bulk(out.channel)) <= 0) return result(r);
+        if ((r = read_bulk(out.payload)) <= 0) return result(r);
+
+        this->pos_ = p;
+        return out;
+    }
+
     std::optional<RedisValue> RespParser::parse_value()
     {
         if (!this->ensure(1)) return std::nullopt;